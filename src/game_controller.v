@@ -7,43 +7,49 @@
 module game_controller (
     input wire clk,
     input wire sys_rst,
+    input wire tick,
     input wire reset_button,
     input wire collision,
     input wire [9:0] scrolladdr,
     
-    output reg game_over,
+    // public_flat_rw only where the C++ harnesses deposit: goosegame_bench
+    // pins game_over and speed_level for its scenarios, goose_env starts
+    // obstacle_pos at a random phase (randomize_phase). The cocotb tests
+    // also deposit obstacle_pos, the jump frame and speed_timer, but cocotb
+    // builds its Verilator model with --public-flat-rw and needs none of these.
+    output reg game_over /* verilator public_flat_rw */,
     output wire game_reset,
     
-    output reg [9:0] obstacle_pos,
-    output reg [2:0] speed_level  // (0-7)
+    output reg [9:0] obstacle_pos /* verilator public_flat_rw */,
+    output wire [9:0] obstacle_pos_next,
+    output reg [2:0] speed_level /* verilator public_flat_rw */  // (0-7)
 );
 
-localparam SPEED_UP_INTERVAL = 125000000;
+// Timebase ticks per speed level (125M cycles at 5000 cycles per tick)
+localparam [14:0] SPEED_UP_INTERVAL = 15'd25000;
 localparam [9:0] OBSTACLE_CYCLE = 10'd700;
 
 reg reset_button_prev;
-reg [26:0] speed_timer;
+reg [14:0] speed_timer;
 reg [9:0] scrolladdr_prev;
 
 wire reset_button_pressed = reset_button && !reset_button_prev;
 
 assign game_reset = reset_button_pressed;
 
+// Obstacle position after this cycle's edge; rendering.v draws from it one
+// cycle early to stay in step with its pipeline
+wire obstacle_step = !game_over && (scrolladdr != scrolladdr_prev);
+assign obstacle_pos_next = (sys_rst || game_reset) ? 10'd0 :
+                           !obstacle_step ? obstacle_pos :
+                           (obstacle_pos >= OBSTACLE_CYCLE - 10'd1) ? 10'd0 : obstacle_pos + 10'd1;
+
 always @(posedge clk) begin
-    if (sys_rst) begin
-        obstacle_pos <= 10'd0;
-        scrolladdr_prev <= 10'd0;
-    end
-    else if (game_reset) begin
-        obstacle_pos <= 10'd0;
+    obstacle_pos <= obstacle_pos_next;
+    if (sys_rst || game_reset)
         scrolladdr_prev <= 10'd0;
-    end
-    else if (!game_over) begin
-        if (scrolladdr != scrolladdr_prev) begin
-            scrolladdr_prev <= scrolladdr;
-            obstacle_pos <= (obstacle_pos >= OBSTACLE_CYCLE - 10'd1) ? 10'd0 : obstacle_pos + 10'd1;
-        end
-    end
+    else if (obstacle_step)
+        scrolladdr_prev <= scrolladdr;
 end
 
 always @(posedge clk) begin
@@ -51,7 +57,7 @@ always @(posedge clk) begin
         game_over <= 1'b0;
         reset_button_prev <= 1'b0;
         speed_level <= 3'd0;
-        speed_timer <= 27'd0;
+        speed_timer <= 15'd0;
     end
     else begin
         reset_button_prev <= reset_button;
@@ -59,17 +65,17 @@ always @(posedge clk) begin
         if (game_reset) begin
             game_over <= 1'b0;
             speed_level <= 3'd0;
-            speed_timer <= 27'd0;
+            speed_timer <= 15'd0;
         end
         else if (collision && !game_over)
             game_over <= 1'b1;
         
-        if (!game_over) begin
-            speed_timer <= speed_timer + 27'd1;
-            if (speed_timer >= SPEED_UP_INTERVAL) begin
+        if (!game_over && tick) begin
+            speed_timer <= speed_timer + 15'd1;
+            if (speed_timer >= SPEED_UP_INTERVAL - 15'd1) begin
                 if (speed_level < 3'd7)
                     speed_level <= speed_level + 3'd1;
-                speed_timer <= 27'd0;
+                speed_timer <= 15'd0;
             end
         end
     end
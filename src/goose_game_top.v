@@ -6,12 +6,20 @@
  * - Rendering (sprites, collision detection)
  * - Jump Physics
  * - Scroll Logic
+ * - Timebase (shared prescaler for scroll, jump and speed-up timing)
  * - VGA Sync Generator
  */
 
 `default_nettype none
 
-module tt_um_goose_game(
+module tt_um_goose_game #(
+  // Divides the timebase tick, and with it the speed-up interval, scroll
+  // periods and jump speed, for faster simulation. 1 for silicon.
+  parameter TIME_SCALE = 1,
+  // Minimal VGA porches and syncs for faster simulation (hvsync_generator).
+  // 0 for silicon.
+  parameter REDUCED_BLANKING = 0
+) (
   input  wire [7:0] ui_in,    // Dedicated inputs
   output wire [7:0] uo_out,   // Dedicated outputs
   input  wire [7:0] uio_in,   // IOs: Input path
@@ -25,6 +33,10 @@ module tt_um_goose_game(
   // ============================================================================
   // VGA Signals
   // ============================================================================
+
+  // Pipeline stages rendering.v adds before a pixel reaches uo_out; the
+  // sync generator hands it positions this many cycles early
+  localparam RENDER_LOOKAHEAD = 2;
   
   wire hsync;
   wire vsync;
@@ -43,18 +55,23 @@ module tt_um_goose_game(
   // Inter-Module Signals
   // ============================================================================
   
+  // From timebase
+  wire tick;
+
   // From game_controller
   wire game_over;
   wire game_reset;
   wire [9:0] obstacle_pos;
+  wire [9:0] obstacle_pos_next;
   wire [2:0] speed_level;
   
   // From jumping
   wire [6:0] jump_pos;
+  wire [6:0] jump_pos_next;
   
-  // From scroll
-  wire [9:0] scrolladdr;
-  wire [17:0] scroll_period;
+  // From scroll; read by the C++ harnesses (game_state.h), never deposited
+  wire [9:0] scrolladdr /* verilator public_flat_rd */;
+  wire [4:0] scroll_period;
   
   // From rendering
   wire collision;
@@ -80,8 +97,12 @@ module tt_um_goose_game(
   // Module Instantiations
   // ============================================================================
 
-  // VGA sync generator
-  hvsync_generator hvsync_gen(
+  // VGA sync generator, positions ahead of the syncs by the depth of the
+  // rendering pipeline
+  hvsync_generator #(
+    .REDUCED_BLANKING(REDUCED_BLANKING),
+    .LOOKAHEAD(RENDER_LOOKAHEAD)
+  ) hvsync_gen(
     .clk(clk),
     .reset(~rst_n),
     .hsync(hsync),
@@ -91,16 +112,26 @@ module tt_um_goose_game(
     .vpos(vpos)
   );
 
+  // Shared prescaler, one tick per 5000 / TIME_SCALE cycles
+  timebase #(.TIME_SCALE(TIME_SCALE)) timebase_inst (
+    .tick(tick),
+    .game_rst(game_reset),
+    .clk(clk),
+    .sys_rst(~rst_n)
+  );
+
   // Game Controller, controls the game state and logic
   game_controller game_ctrl(
     .clk(clk),
     .sys_rst(~rst_n),
+    .tick(tick),
     .reset_button(reset_button),
     .collision(collision),
     .scrolladdr(scrolladdr),
     .game_over(game_over),
     .game_reset(game_reset),
     .obstacle_pos(obstacle_pos),
+    .obstacle_pos_next(obstacle_pos_next),
     .speed_level(speed_level)
   );
 
@@ -109,7 +140,9 @@ module tt_um_goose_game(
     .jump(jump_button),
     .scroll_period(scroll_period),
     .jump_pos(jump_pos),
+    .jump_pos_next(jump_pos_next),
     .halt(game_over),
+    .tick(tick),
     .game_rst(game_reset),
     .clk(clk),
     .sys_rst(~rst_n)
@@ -120,6 +153,7 @@ module tt_um_goose_game(
     .pos(scrolladdr),
     .period_out(scroll_period),
     .halt(game_over),
+    .tick(tick),
     .speed_level(speed_level),
     .game_rst(game_reset),
     .clk(clk),
@@ -133,8 +167,8 @@ module tt_um_goose_game(
     .B(B),
     .collision(collision),
     .game_over(game_over),
-    .obstacle_pos(obstacle_pos),
-    .jump_pos(jump_pos),
+    .obstacle_pos_next(obstacle_pos_next),
+    .jump_pos_next(jump_pos_next),
     .vaddr(vpos),
     .haddr(hpos),
     .display_on(display_on),
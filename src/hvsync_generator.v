@@ -1,15 +1,26 @@
 /*
  * VGA timing generator
  * 640x480 @ 60Hz
+ *
+ * REDUCED_BLANKING=1 shrinks every porch and sync pulse to one cycle
+ * (643x483 total instead of 800x525) so simulation spends ~26% fewer
+ * cycles per frame. Sim only: no monitor accepts it. 0 for silicon.
+ *
+ * hpos, vpos and display_on run LOOKAHEAD cycles ahead of hsync and
+ * vsync, so a renderer pipelined that deep puts each pixel out on the
+ * same cycle as an unpipelined one fed the current position.
  */
 
 `default_nettype none
 
-module hvsync_generator(
+module hvsync_generator #(
+  parameter REDUCED_BLANKING = 0,
+  parameter LOOKAHEAD = 0
+) (
   input wire clk,
   input wire reset,
-  output reg hsync,
-  output reg vsync,
+  output wire hsync,
+  output wire vsync,
   output wire display_on,
   output reg [9:0] hpos,
   output reg [9:0] vpos
@@ -17,23 +28,23 @@ module hvsync_generator(
 
   // VGA 640x480 @ 60Hz timing parameters
   localparam H_DISPLAY = 640;
-  localparam H_FRONT = 16;
-  localparam H_SYNC = 96;
-  localparam H_BACK = 48;
+  localparam H_FRONT = REDUCED_BLANKING ? 1 : 16;
+  localparam H_SYNC = REDUCED_BLANKING ? 1 : 96;
+  localparam H_BACK = REDUCED_BLANKING ? 1 : 48;
   
   localparam V_DISPLAY = 480;
-  localparam V_BOTTOM = 10;
-  localparam V_SYNC = 2;
-  localparam V_TOP = 33;
+  localparam V_BOTTOM = REDUCED_BLANKING ? 1 : 10;
+  localparam V_SYNC = REDUCED_BLANKING ? 1 : 2;
+  localparam V_TOP = REDUCED_BLANKING ? 1 : 33;
   
-  // Derived constants
-  localparam H_SYNC_START = H_DISPLAY + H_FRONT;              // 656
-  localparam H_SYNC_END = H_DISPLAY + H_FRONT + H_SYNC - 1;   // 751
-  localparam H_MAX = H_DISPLAY + H_BACK + H_FRONT + H_SYNC - 1; // 799
+  // Derived constants (standard VGA / REDUCED_BLANKING values)
+  localparam H_SYNC_START = H_DISPLAY + H_FRONT;              // 656 / 641
+  localparam H_SYNC_END = H_DISPLAY + H_FRONT + H_SYNC - 1;   // 751 / 641
+  localparam H_MAX = H_DISPLAY + H_BACK + H_FRONT + H_SYNC - 1; // 799 / 642
   
-  localparam V_SYNC_START = V_DISPLAY + V_BOTTOM;             // 490
-  localparam V_SYNC_END = V_DISPLAY + V_BOTTOM + V_SYNC - 1;  // 491
-  localparam V_MAX = V_DISPLAY + V_TOP + V_BOTTOM + V_SYNC - 1; // 524
+  localparam V_SYNC_START = V_DISPLAY + V_BOTTOM;             // 490 / 481
+  localparam V_SYNC_END = V_DISPLAY + V_BOTTOM + V_SYNC - 1;  // 491 / 481
+  localparam V_MAX = V_DISPLAY + V_TOP + V_BOTTOM + V_SYNC - 1; // 524 / 482
 
   reg [9:0] h_count;
   reg [9:0] v_count;
@@ -41,18 +52,43 @@ module hvsync_generator(
   wire hmaxxed = (h_count == H_MAX) || reset;
   wire vmaxxed = (v_count == V_MAX) || reset;
 
-  // Horizontal counter and sync generation
+  // Syncs of the counter position, delayed LOOKAHEAD more cycles
+  reg hsync_pipe [0:LOOKAHEAD];
+  reg vsync_pipe [0:LOOKAHEAD];
+  integer i;
+
+  always @(posedge clk) begin
+    if (reset) begin
+      for (i = 0; i <= LOOKAHEAD; i = i + 1) begin
+        hsync_pipe[i] <= 1'b1;
+        vsync_pipe[i] <= 1'b1;
+      end
+    end
+    else begin
+      hsync_pipe[0] <= ~(h_count >= H_SYNC_START && h_count <= H_SYNC_END);
+      vsync_pipe[0] <= ~(v_count >= V_SYNC_START && v_count <= V_SYNC_END);
+      for (i = 1; i <= LOOKAHEAD; i = i + 1) begin
+        hsync_pipe[i] <= hsync_pipe[i-1];
+        vsync_pipe[i] <= vsync_pipe[i-1];
+      end
+    end
+  end
+
+  assign hsync = hsync_pipe[LOOKAHEAD];
+  assign vsync = vsync_pipe[LOOKAHEAD];
+
+  // Horizontal counter, LOOKAHEAD pixels into the line after reset
   always @(posedge clk) begin
-    hsync <= ~(h_count >= H_SYNC_START && h_count <= H_SYNC_END);
-    if (hmaxxed)
+    if (reset)
+      h_count <= LOOKAHEAD;
+    else if (h_count == H_MAX)
       h_count <= 10'd0;
     else
       h_count <= h_count + 10'd1;
   end
 
-  // Vertical counter and sync generation
+  // Vertical counter
   always @(posedge clk) begin
-    vsync <= ~(v_count >= V_SYNC_START && v_count <= V_SYNC_END);
     if (hmaxxed) begin
       if (vmaxxed)
         v_count <= 10'd0;
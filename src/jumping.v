@@ -7,17 +7,20 @@
 module jumping (
     input wire jump,
     input wire halt,
-    input wire [17:0] scroll_period,
-    output reg [6:0] jump_pos,
+    input wire tick,
+    input wire [4:0] scroll_period,
+    // Read by the C++ harnesses (game_state.h), never deposited
+    output reg [6:0] jump_pos /* verilator public_flat_rd */,
+    output wire [6:0] jump_pos_next,
     input wire game_rst,
     input wire clk,
     input wire sys_rst
 );
 
-// Jump speed scales with scroll speed (2x scroll period)
-wire [18:0] jump_speed = {scroll_period, 1'b0};  // scroll_period << 1
+// Jump speed scales with scroll speed (2x scroll period), in timebase ticks
+wire [5:0] jump_speed = {scroll_period, 1'b0};  // scroll_period << 1
 
-reg [18:0] ctr;      // Counter for jump animation timing
+reg [5:0] ctr;       // Ticks into the current jump frame
 reg [5:0] frame;     // Current frame in jump cycle
 reg in_air;          // Jump state flag
 reg [6:0] y_table[25:0];  // Jump height lookup table (parabolic curve)
@@ -26,28 +29,31 @@ reg [6:0] y_table[25:0];  // Jump height lookup table (parabolic curve)
 wire [5:0] mirror_frame = 6'd50 - frame;
 wire [4:0] table_idx = (frame <= 6'd25) ? frame[4:0] : mirror_frame[4:0];
 
+// Height after this cycle's edge, for rendering.v's pipeline
+assign jump_pos_next = (game_rst || sys_rst) ? 7'd0 : y_table[table_idx];
+
 // Jump physics state machine
 always @(posedge clk) begin
+    jump_pos <= jump_pos_next;
     if (game_rst || sys_rst) begin
-        ctr <= 19'd0;
+        ctr <= 6'd0;
         frame <= 6'd0;
         in_air <= 1'b0;
-        jump_pos <= 7'd0;
     end
     else begin
-        // Output current jump height from lookup table
-        jump_pos <= y_table[table_idx];
         if (!halt) begin
             if (in_air) begin
-                // Advance jump animation every jump_speed cycles
-                ctr <= ctr + 19'd1;
-                if (ctr == jump_speed) begin
-                    ctr <= 19'd0;
-                    frame <= frame + 6'd1;
-                    // Complete jump cycle: 50 frames (25 up, 25 down)
-                    if (frame + 6'd1 >= 6'd50) begin
-                        frame <= 6'd0;
-                        in_air <= 1'b0;
+                // Advance jump animation every jump_speed ticks
+                if (tick) begin
+                    ctr <= ctr + 6'd1;
+                    if (ctr >= jump_speed - 6'd1) begin
+                        ctr <= 6'd0;
+                        frame <= frame + 6'd1;
+                        // Complete jump cycle: 50 frames (25 up, 25 down)
+                        if (frame + 6'd1 >= 6'd50) begin
+                            frame <= 6'd0;
+                            in_air <= 1'b0;
+                        end
                     end
                 end
             end
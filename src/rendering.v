@@ -1,5 +1,18 @@
 /*
  * Rendering module for goose game
+ *
+ * Three-stage pixel pipeline fed with positions two cycles ahead of the
+ * syncs (hvsync_generator LOOKAHEAD = 2):
+ *   1. raster: display enable and the position's sprite rows and columns
+ *   2. geometry: sprite bounds and ROM coordinates from the obstacle and
+ *      jump positions
+ *   3. ROM lookup, game-over color, palette and layer bits
+ * The layers are composited by priority as before. Stage 2 runs one cycle
+ * before the layers are registered, so it takes the positions after the
+ * coming edge (obstacle_pos_next, jump_pos_next), and stage 3 takes
+ * game_over as it is. Every pixel, sync and collision therefore comes out
+ * on the same cycle and from the same game state as from a single-stage
+ * renderer fed the current position.
  */
 
 `default_nettype none
@@ -12,8 +25,9 @@ module rendering (
 
     input wire game_over,
 
-    input wire [9:0] obstacle_pos,
-    input wire [6:0] jump_pos,
+    // Game registers after the coming clock edge
+    input wire [9:0] obstacle_pos_next,
+    input wire [6:0] jump_pos_next,
     input wire [9:0] vaddr,
     input wire [9:0] haddr,
     input wire display_on,
@@ -51,8 +65,14 @@ localparam [COLOR_BITS-1:0] COLOR_GOOSE_BODY = 3'd1;
 localparam [COLOR_BITS-1:0] COLOR_BLACK = 3'd2;
 localparam [COLOR_BITS-1:0] COLOR_BEAK = 3'd3;
 localparam [COLOR_BITS-1:0] COLOR_RED = 3'd4;
+localparam [COLOR_BITS-1:0] COLOR_WHITE = 3'd5;
+localparam [COLOR_BITS-1:0] COLOR_GOLD = 3'd6;
+
+localparam integer EMBLEM_ROM_WIDTH = 20;
+localparam integer EMBLEM_ROM_HEIGHT = 24;
 
 reg [COLOR_BITS*GOOSE_ROM_WIDTH-1:0] goose_rom [0:GOOSE_ROM_HEIGHT-1];
+reg [COLOR_BITS*EMBLEM_ROM_WIDTH-1:0] emblem_rom [0:EMBLEM_ROM_HEIGHT-1];
 
 // Color palette: converts color index to RGB222
 function [5:0] palette;
@@ -63,6 +83,8 @@ function [5:0] palette;
             COLOR_BLACK:      palette = {2'b00, 2'b00, 2'b00};
             COLOR_BEAK:       palette = {2'b11, 2'b11, 2'b00};
             COLOR_RED:        palette = {2'b11, 2'b00, 2'b00};
+            COLOR_WHITE:      palette = {2'b11, 2'b11, 2'b11};
+            COLOR_GOLD:       palette = {2'b11, 2'b11, 2'b00};
             default:          palette = 6'b000000;
         endcase
     end
@@ -83,6 +105,21 @@ function [COLOR_BITS-1:0] goose_pixel_from_row;
     end
 endfunction
 
+// Extract pixel color from packed emblem ROM row
+function [COLOR_BITS-1:0] emblem_pixel_from_row;
+    input [COLOR_BITS*EMBLEM_ROM_WIDTH-1:0] row_bits;
+    input [4:0] px;
+    integer shift;
+    integer msb;
+    integer px_int;
+    begin
+        px_int = {{(32-5){1'b0}}, px};
+        shift = px_int * COLOR_BITS;
+        msb = (EMBLEM_ROM_WIDTH*COLOR_BITS - 1) - shift;
+        emblem_pixel_from_row = row_bits[msb -: COLOR_BITS];
+    end
+endfunction
+
 initial begin
     goose_rom[0]  = 48'b000000000000000000000000000000000000000000000000;
     goose_rom[1]  = 48'b000000000000000000000000000000000000000000000000;
@@ -102,6 +139,35 @@ initial begin
     goose_rom[15] = 48'b000000000000010010000000000010010000000000000000;
 end
 
+// University of Waterloo emblem, 2x2 screen pixels per ROM pixel like the
+// goose: gold shield, black and white borders, chevron and three red lions
+initial begin
+    emblem_rom[0]  = 60'b010010010010010010010010010010010010010010010010010010010010;
+    emblem_rom[1]  = 60'b010101101101101101101101101101101101101101101101101101101010;
+    emblem_rom[2]  = 60'b010101110110110110110110110110110110110110110110110110101010;
+    emblem_rom[3]  = 60'b010101110110110110100110110110110110110100110110110110101010;
+    emblem_rom[4]  = 60'b010101110110100100100100110110110110100100100100110110101010;
+    emblem_rom[5]  = 60'b010101110110100100100100110110110110100100100100110110101010;
+    emblem_rom[6]  = 60'b010101110110100100100110110110110110110100100100110110101010;
+    emblem_rom[7]  = 60'b010101110110110110110110010010010010110110110110110110101010;
+    emblem_rom[8]  = 60'b010101110110110110110010101101101101010110110110110110101010;
+    emblem_rom[9]  = 60'b010101110110110110010101101010010101101010110110110110101010;
+    emblem_rom[10] = 60'b010101110110110010101101010110110010101101010110110110101010;
+    emblem_rom[11] = 60'b010101110110010101101010110110110110010101101010110110101010;
+    emblem_rom[12] = 60'b010101110010101101010110110110110110110010101101010110101010;
+    emblem_rom[13] = 60'b010101010101101010110110110110110110110110010101101010101010;
+    emblem_rom[14] = 60'b010010101101010110110110110100100110110110110010101101010010;
+    emblem_rom[15] = 60'b010101101010110110110110100100100100110110110110010101101010;
+    emblem_rom[16] = 60'b000010101110110110110100100100100100100110110110110101010000;
+    emblem_rom[17] = 60'b000000010101110110110110100100100100110110110110101010000000;
+    emblem_rom[18] = 60'b000000000010101110110110100100100100110110110101010000000000;
+    emblem_rom[19] = 60'b000000000000010101110110110110110110110110101010000000000000;
+    emblem_rom[20] = 60'b000000000000000010101110110110110110110101010000000000000000;
+    emblem_rom[21] = 60'b000000000000000000010101110110110110101010000000000000000000;
+    emblem_rom[22] = 60'b000000000000000000000010101110110101010000000000000000000000;
+    emblem_rom[23] = 60'b000000000000000000000000010010010010000000000000000000000000;
+end
+
 // Collision detection: goose and obstacle overlap
 assign collision = layers[LAYER_GOOSE] & layers[LAYER_OBSTACLE];
 
@@ -125,43 +191,123 @@ assign final_b = (layers[LAYER_GOOSE] ? goose_b :
                   layers[LAYER_FLOOR] ? 2'b01 :
                   layers[LAYER_SKY] ? 2'b11 : 2'b00);
 
-assign R = display_on ? final_r : 2'b00;
-assign G = display_on ? final_g : 2'b00;
-assign B = display_on ? final_b : 2'b00;
+// Stage 2 holds the display enable of the position after the one in the
+// layers, which is what the single-stage renderer blanked with
+reg s2_display_on;
+assign R = s2_display_on ? final_r : 2'b00;
+assign G = s2_display_on ? final_g : 2'b00;
+assign B = s2_display_on ? final_b : 2'b00;
+
+// ----------------------------------------------------------------------------
+// Stage 1: raster
+// ----------------------------------------------------------------------------
 
 wire [10:0] vaddr_ext = {1'b0, vaddr};
 wire [10:0] haddr_ext = {1'b0, haddr};
 
+reg s1_display_on, s1_sky, s1_floor_line, s1_goose_column, s1_obstacle_rows;
+reg [10:0] s1_vaddr, s1_haddr;
+
+// Reset to the raster of the first two pixels after reset, (1,0) here and
+// (0,0) in stage 2, so the first line matches the single-stage renderer
+always @(posedge clk) begin
+    if (sys_rst) begin
+        s1_display_on <= 1'b1;
+        s1_sky <= 1'b1;
+        s1_floor_line <= 1'b0;
+        s1_goose_column <= 1'b0;
+        s1_obstacle_rows <= 1'b0;
+        s1_vaddr <= 11'd0;
+        s1_haddr <= 11'd1;
+    end
+    else begin
+        s1_display_on <= display_on;
+        s1_sky <= vaddr_ext < FLOOR_Y;
+        s1_floor_line <= vaddr_ext == FLOOR_Y;
+        s1_goose_column <= haddr_ext[10:5] == 6'b000010;
+        s1_obstacle_rows <= (vaddr_ext >= OBSTACLE_TOP) && (vaddr_ext < FLOOR_Y);
+        s1_vaddr <= vaddr_ext;
+        s1_haddr <= haddr_ext;
+    end
+end
+
+// ----------------------------------------------------------------------------
+// Stage 2: geometry
+// ----------------------------------------------------------------------------
+
 // Goose sprite positioning and bounds checking
-wire [10:0] goose_y = GOOSE_Y_BASE - {4'd0, jump_pos};
-wire goose_x_in_bounds = (haddr_ext[10:5] == 6'b000010);
-wire goose_in_bounds = goose_x_in_bounds &&
-                       (vaddr_ext >= goose_y) && (vaddr_ext < (goose_y + GOOSE_HEIGHT_PX));
-wire goose_active = goose_in_bounds && display_on;
-
-wire [3:0] goose_rom_x = haddr_ext[4:1];
-wire [3:0] goose_rom_y = vaddr_ext[4:1] - goose_y[4:1];
-
-wire [COLOR_BITS*GOOSE_ROM_WIDTH-1:0] goose_row_bits = goose_rom[goose_rom_y];
-wire [COLOR_BITS-1:0] goose_pixel_raw = goose_pixel_from_row(goose_row_bits, goose_rom_x);
-wire [COLOR_BITS-1:0] goose_pixel_idx = goose_active ? goose_pixel_raw : COLOR_TRANSPARENT;
-wire [COLOR_BITS-1:0] goose_color_idx =
-    (game_over && goose_pixel_idx != COLOR_TRANSPARENT) ? COLOR_RED : goose_pixel_idx;
-wire [5:0] goose_rgb = palette(goose_color_idx);
+wire [10:0] goose_y = GOOSE_Y_BASE - {4'd0, jump_pos_next};
+wire goose_in_bounds = s1_goose_column &&
+                       (s1_vaddr >= goose_y) && (s1_vaddr < (goose_y + GOOSE_HEIGHT_PX));
+wire goose_active = goose_in_bounds && s1_display_on;
+
+wire [3:0] goose_rom_x = s1_haddr[4:1];
+wire [3:0] goose_rom_y = s1_vaddr[4:1] - goose_y[4:1];
 
 // Obstacle (emblem) positioning and bounds checking
-wire [10:0] obstacle_x = SCREEN_WIDTH - {1'b0, obstacle_pos} + OBSTACLE_OFFSET;
+wire [10:0] obstacle_x = SCREEN_WIDTH - {1'b0, obstacle_pos_next} + OBSTACLE_OFFSET;
 wire [10:0] obstacle_right = obstacle_x + UW_WIDTH_PX;
-wire obstacle_in_bounds = display_on &&
-                          (haddr_ext >= obstacle_x) && (haddr_ext < obstacle_right) &&
-                          (vaddr_ext >= OBSTACLE_TOP) && (vaddr_ext < FLOOR_Y);
+wire obstacle_in_bounds = s1_display_on && s1_obstacle_rows &&
+                          (s1_haddr >= obstacle_x) && (s1_haddr < obstacle_right);
 
-wire [5:0] emblem_local_x = obstacle_in_bounds ? (haddr_ext[5:0] - obstacle_x[5:0]) : 6'd0;
-wire [5:0] emblem_local_y = obstacle_in_bounds ? (vaddr_ext[5:0] - OBSTACLE_TOP[5:0]) : 6'd0;
+wire [5:0] emblem_local_x = obstacle_in_bounds ? (s1_haddr[5:0] - obstacle_x[5:0]) : 6'd0;
+wire [5:0] emblem_local_y = obstacle_in_bounds ? (s1_vaddr[5:0] - OBSTACLE_TOP[5:0]) : 6'd0;
+wire [4:0] emblem_rom_x = emblem_local_x[5:1];
+wire [4:0] emblem_rom_y = emblem_local_y[5:1];
 
-wire [3:0] floor_scroll_pos = haddr_ext[3:0] + obstacle_pos[3:0];
+// Dotted texture at the top of the floor (1 pixel high), a dot every 16
+// pixels that scrolls with the game
+wire [3:0] floor_scroll_pos = s1_haddr[3:0] + obstacle_pos_next[3:0];
+wire floor_dot = s1_floor_line &&
+                 (floor_scroll_pos[3:0] >= 4'd2) && (floor_scroll_pos[3:0] <= 4'd5);
+
+reg s2_sky, s2_floor_dot;
+reg s2_goose_active, s2_obstacle_in_bounds;
+reg [3:0] s2_goose_rom_x, s2_goose_rom_y;
+reg [4:0] s2_emblem_x, s2_emblem_y;
+
+always @(posedge clk) begin
+    if (sys_rst) begin
+        s2_display_on <= 1'b1;
+        s2_sky <= 1'b1;
+        s2_floor_dot <= 1'b0;
+        s2_goose_active <= 1'b0;
+        s2_obstacle_in_bounds <= 1'b0;
+        s2_goose_rom_x <= 4'd0;
+        s2_goose_rom_y <= 4'd0;
+        s2_emblem_x <= 5'd0;
+        s2_emblem_y <= 5'd0;
+    end
+    else begin
+        s2_display_on <= s1_display_on;
+        s2_sky <= s1_sky;
+        s2_floor_dot <= floor_dot;
+        s2_goose_active <= goose_active;
+        s2_obstacle_in_bounds <= obstacle_in_bounds;
+        s2_goose_rom_x <= goose_rom_x;
+        s2_goose_rom_y <= goose_rom_y;
+        s2_emblem_x <= emblem_rom_x;
+        s2_emblem_y <= emblem_rom_y;
+    end
+end
+
+// ----------------------------------------------------------------------------
+// Stage 3: ROM lookup, palette and layers
+// ----------------------------------------------------------------------------
+
+wire [COLOR_BITS*GOOSE_ROM_WIDTH-1:0] goose_row_bits = goose_rom[s2_goose_rom_y];
+wire [COLOR_BITS-1:0] goose_pixel_raw = goose_pixel_from_row(goose_row_bits, s2_goose_rom_x);
+wire [COLOR_BITS-1:0] goose_pixel_idx = s2_goose_active ? goose_pixel_raw : COLOR_TRANSPARENT;
+wire [COLOR_BITS-1:0] goose_color_idx =
+    (game_over && goose_pixel_idx != COLOR_TRANSPARENT) ? COLOR_RED : goose_pixel_idx;
+
+wire [COLOR_BITS*EMBLEM_ROM_WIDTH-1:0] emblem_row_bits = emblem_rom[s2_emblem_y];
+wire [COLOR_BITS-1:0] emblem_color_idx =
+    s2_obstacle_in_bounds ? emblem_pixel_from_row(emblem_row_bits, s2_emblem_x) : COLOR_TRANSPARENT;
+
+wire [5:0] goose_rgb = palette(goose_color_idx);
+wire [5:0] emblem_rgb = palette(emblem_color_idx);
 
-// Pixel-by-pixel rendering pipeline
 always @(posedge clk) begin
     if (sys_rst) begin
         layers <= 5'd0;
@@ -181,130 +327,27 @@ always @(posedge clk) begin
         emblem_r <= 2'b00;
         emblem_g <= 2'b00;
         emblem_b <= 2'b00;
-        
-        if (display_on) begin
-            if (vaddr_ext < FLOOR_Y) begin
+
+        if (s2_display_on) begin
+            if (s2_sky) begin
                 layers[LAYER_SKY] <= 1'b1;
             end
             else begin
                 layers[LAYER_FLOOR] <= 1'b1;
-                // Add dotted texture at top of floor (1 pixel high) that scrolls
-                if (vaddr_ext == FLOOR_Y) begin
-                    // Create dots every 16 pixels that scroll with the game
-                    if (floor_scroll_pos[3:0] >= 4'd2 && 
-                        floor_scroll_pos[3:0] <= 4'd5) begin
-                        layers[LAYER_FLOOR_DOTS] <= 1'b1;
-                    end
+                if (s2_floor_dot) begin
+                    layers[LAYER_FLOOR_DOTS] <= 1'b1;
                 end
             end
-            
-            if (goose_pixel_idx != COLOR_TRANSPARENT) begin
-                    layers[LAYER_GOOSE] <= 1'b1;
+
+            if (goose_color_idx != COLOR_TRANSPARENT) begin
+                layers[LAYER_GOOSE] <= 1'b1;
                 {goose_r, goose_g, goose_b} <= goose_rgb;
             end
 
             // Render University of Waterloo emblem (obstacle)
-            if (obstacle_in_bounds) begin
-                // Red lions
-                if (((emblem_local_y >= 7 && emblem_local_y <= 13) && 
-                     (emblem_local_x >= 7 && emblem_local_x <= 15)) &&
-                    (((emblem_local_y >= 8 && emblem_local_y <= 13) && (emblem_local_x >= 8 && emblem_local_x <= 13)) ||
-                     ((emblem_local_y >= 7 && emblem_local_y <= 9) && (emblem_local_x >= 12 && emblem_local_x <= 14)) ||
-                     ((emblem_local_y >= 9 && emblem_local_y <= 10) && (emblem_local_x >= 14 && emblem_local_x <= 15)))) begin
-                    layers[LAYER_OBSTACLE] <= 1'b1;
-                    emblem_r <= 2'b11; emblem_g <= 2'b00; emblem_b <= 2'b00;
-                end
-                else if (((emblem_local_y >= 7 && emblem_local_y <= 13) && 
-                          (emblem_local_x >= 25 && emblem_local_x <= 33)) &&
-                         (((emblem_local_y >= 8 && emblem_local_y <= 13) && (emblem_local_x >= 27 && emblem_local_x <= 32)) ||
-                          ((emblem_local_y >= 7 && emblem_local_y <= 9) && (emblem_local_x >= 26 && emblem_local_x <= 28)) ||
-                          ((emblem_local_y >= 9 && emblem_local_y <= 10) && (emblem_local_x >= 25 && emblem_local_x <= 26)))) begin
-                    layers[LAYER_OBSTACLE] <= 1'b1;
-                    emblem_r <= 2'b11; emblem_g <= 2'b00; emblem_b <= 2'b00;
-                end
-                else if (((emblem_local_y >= 28 && emblem_local_y <= 37) && 
-                          (emblem_local_x >= 15 && emblem_local_x <= 25)) &&
-                         (((emblem_local_y >= 30 && emblem_local_y <= 37) && (emblem_local_x >= 16 && emblem_local_x <= 24)) ||
-                          ((emblem_local_y >= 28 && emblem_local_y <= 31) && (emblem_local_x >= 18 && emblem_local_x <= 22)) ||
-                          ((emblem_local_y >= 32 && emblem_local_y <= 33) && 
-                           ((emblem_local_x >= 15 && emblem_local_x <= 16) || (emblem_local_x >= 24 && emblem_local_x <= 25))))) begin
-                    layers[LAYER_OBSTACLE] <= 1'b1;
-                    emblem_r <= 2'b11; emblem_g <= 2'b00; emblem_b <= 2'b00;
-                end
-                // White chevron
-                else if (((emblem_local_y >= 17 && emblem_local_y <= 31)) &&
-                         (((emblem_local_x >= (7 + (28 - emblem_local_y))) && 
-                           (emblem_local_x <= (9 + (28 - emblem_local_y)))) ||
-                          ((emblem_local_x >= (31 - (28 - emblem_local_y))) && 
-                           (emblem_local_x <= (33 - (28 - emblem_local_y)))))) begin
-                    layers[LAYER_OBSTACLE] <= 1'b1;
-                    emblem_r <= 2'b11; emblem_g <= 2'b11; emblem_b <= 2'b11;
-                end
-                // Black chevron
-                else if (((emblem_local_y >= 15 && emblem_local_y <= 31)) &&
-                         (((emblem_local_x >= (4 + (29 - emblem_local_y))) && 
-                           (emblem_local_x <= (9 + (29 - emblem_local_y)))) ||
-                          ((emblem_local_x >= (31 - (29 - emblem_local_y))) && 
-                           (emblem_local_x <= (36 - (29 - emblem_local_y)))))) begin
-                    layers[LAYER_OBSTACLE] <= 1'b1;
-                    emblem_r <= 2'b00; emblem_g <= 2'b00; emblem_b <= 2'b00;
-                end
-                // White border
-                else if (
-                        ((emblem_local_y == 2) && 
-                         (emblem_local_x >= 1 && emblem_local_x <= 38)) ||
-                        ((emblem_local_y >= 3 && emblem_local_y <= 30) && 
-                         ((emblem_local_x == 1) || (emblem_local_x == 38))) ||
-                        ((emblem_local_y >= 31 && emblem_local_y <= 35) && 
-                         ((emblem_local_x == (1 + (emblem_local_y - 30))) || 
-                          (emblem_local_x == (38 - (emblem_local_y - 30))))) ||
-                        ((emblem_local_y >= 36 && emblem_local_y <= 42) && 
-                         ((emblem_local_x == (6 + (emblem_local_y - 35))) || 
-                          (emblem_local_x == (33 - (emblem_local_y - 35))))) ||
-                        ((emblem_local_y >= 43 && emblem_local_y <= 45) && 
-                         ((emblem_local_x == (14 + (emblem_local_y - 43))) || 
-                          (emblem_local_x == (25 - (emblem_local_y - 43)))))
-                ) begin
-                    layers[LAYER_OBSTACLE] <= 1'b1;
-                    emblem_r <= 2'b11; emblem_g <= 2'b11; emblem_b <= 2'b11;
-                end
-                // Gold background
-                else if (
-                        ((emblem_local_y >= 3 && emblem_local_y <= 30) && 
-                         (emblem_local_x >= 2 && emblem_local_x <= 37)) ||
-                        ((emblem_local_y >= 31 && emblem_local_y <= 35) && 
-                         (emblem_local_x >= (2 + (emblem_local_y - 30)) && 
-                          emblem_local_x <= (37 - (emblem_local_y - 30)))) ||
-                        ((emblem_local_y >= 36 && emblem_local_y <= 42) && 
-                         (emblem_local_x >= (7 + (emblem_local_y - 35)) && 
-                          emblem_local_x <= (32 - (emblem_local_y - 35)))) ||
-                        ((emblem_local_y >= 43 && emblem_local_y <= 45) && 
-                         (emblem_local_x >= (15 + (emblem_local_y - 43)) && 
-                          emblem_local_x <= (24 - (emblem_local_y - 43))))
-                ) begin
-                    layers[LAYER_OBSTACLE] <= 1'b1;
-                    emblem_r <= 2'b11; emblem_g <= 2'b11; emblem_b <= 2'b00;
-                end
-                // Black border
-                else if (
-                        (emblem_local_y <= 1) ||
-                        ((emblem_local_y >= 2 && emblem_local_y <= 30) && 
-                         ((emblem_local_x == 0) || (emblem_local_x == 39))) ||
-                        ((emblem_local_y >= 31 && emblem_local_y <= 35) && 
-                         ((emblem_local_x >= (emblem_local_y - 30) - 1 && emblem_local_x <= (emblem_local_y - 30)) || 
-                          (emblem_local_x >= (39 - (emblem_local_y - 30)) && emblem_local_x <= (39 - (emblem_local_y - 30)) + 1))) ||
-                        ((emblem_local_y >= 36 && emblem_local_y <= 42) && 
-                         ((emblem_local_x >= (5 + (emblem_local_y - 35)) - 1 && emblem_local_x <= (5 + (emblem_local_y - 35))) || 
-                          (emblem_local_x >= (34 - (emblem_local_y - 35)) && emblem_local_x <= (34 - (emblem_local_y - 35)) + 1))) ||
-                        ((emblem_local_y >= 43 && emblem_local_y <= 45) && 
-                         ((emblem_local_x >= (13 + (emblem_local_y - 43)) - 1 && emblem_local_x <= (13 + (emblem_local_y - 43))) || 
-                          (emblem_local_x >= (26 - (emblem_local_y - 43)) && emblem_local_x <= (26 - (emblem_local_y - 43)) + 1))) ||
-                    ((emblem_local_y >= 46 && emblem_local_y <= 47) && 
-                      ((emblem_local_x >= 16) && (emblem_local_x <= 23)))
-                ) begin
-                    layers[LAYER_OBSTACLE] <= 1'b1;
-                    emblem_r <= 2'b00; emblem_g <= 2'b00; emblem_b <= 2'b00;
-                end
+            if (emblem_color_idx != COLOR_TRANSPARENT) begin
+                layers[LAYER_OBSTACLE] <= 1'b1;
+                {emblem_r, emblem_g, emblem_b} <= emblem_rgb;
             end
         end
     end
@@ -6,9 +6,10 @@
 
 module scroll (
     input wire halt,
+    input wire tick,
     input wire [2:0] speed_level,
     output reg [9:0] pos,
-    output wire [17:0] period_out,
+    output wire [4:0] period_out,
     input wire game_rst,
     input wire clk,
     input wire sys_rst
@@ -16,8 +17,20 @@ module scroll (
 
 localparam [9:0] MOVE_STEP = 10'd2;
 
-reg [17:0] ctr;
-reg [17:0] current_period;
+// Scroll periods per speed level in timebase ticks (110000 down to 10000
+// cycles at 5000 cycles per tick). jumping.v derives its speed from these,
+// so jumps scale with them.
+localparam [4:0] PERIOD_0 = 5'd22;
+localparam [4:0] PERIOD_1 = 5'd19;
+localparam [4:0] PERIOD_2 = 5'd16;
+localparam [4:0] PERIOD_3 = 5'd13;
+localparam [4:0] PERIOD_4 = 5'd10;
+localparam [4:0] PERIOD_5 = 5'd7;
+localparam [4:0] PERIOD_6 = 5'd4;
+localparam [4:0] PERIOD_7 = 5'd2;
+
+reg [4:0] ctr;
+reg [4:0] current_period;
 
 // Output current period for jump speed calculation
 assign period_out = current_period;
@@ -25,30 +38,30 @@ assign period_out = current_period;
 // Lookup table: convert speed_level to scroll period (lower = faster)
 always @(*) begin
     case (speed_level)
-        3'd0: current_period = 18'd110000;
-        3'd1: current_period = 18'd95000;
-        3'd2: current_period = 18'd80000;
-        3'd3: current_period = 18'd65000;
-        3'd4: current_period = 18'd50000;
-        3'd5: current_period = 18'd35000;
-        3'd6: current_period = 18'd20000;
-        default: current_period = 18'd10000;
+        3'd0: current_period = PERIOD_0;
+        3'd1: current_period = PERIOD_1;
+        3'd2: current_period = PERIOD_2;
+        3'd3: current_period = PERIOD_3;
+        3'd4: current_period = PERIOD_4;
+        3'd5: current_period = PERIOD_5;
+        3'd6: current_period = PERIOD_6;
+        default: current_period = PERIOD_7;
     endcase
 end
 
-// Scroll position counter: increments every current_period cycles
+// Scroll position counter: increments every current_period ticks
 always @(posedge clk) begin
     if (game_rst || sys_rst) begin
         pos <= 10'd0;
-        ctr <= 18'd0;
+        ctr <= 5'd0;
     end
-    else if (!halt) begin
-        if (ctr >= current_period) begin
-            ctr <= 18'd0;
+    else if (!halt && tick) begin
+        if (ctr >= current_period - 5'd1) begin
+            ctr <= 5'd0;
             pos <= pos + MOVE_STEP;
         end
         else begin
-            ctr <= ctr + 18'd1;
+            ctr <= ctr + 5'd1;
         end
     end
 end
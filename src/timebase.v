@@ -0,0 +1,47 @@
+/*
+ * Shared timebase for goose game
+ *
+ * One prescaler for the whole game: tick is high for one cycle in every
+ * TICK_CYCLES. Every scroll period, and with it every jump frame, and the
+ * speed-up interval are whole numbers of ticks, so scroll, jumping and
+ * game_controller count ticks in a few bits instead of cycles in 18-27.
+ * Restarts on the reset button so the first scroll step and speed-up after
+ * a game reset are a whole period away.
+ */
+
+`default_nettype none
+
+module timebase #(
+    parameter TIME_SCALE = 1
+) (
+    output wire tick,
+    input wire game_rst,
+    input wire clk,
+    input wire sys_rst
+);
+
+// 200 us at 25 MHz, divided by TIME_SCALE in fast simulation builds
+localparam [12:0] TICK_CYCLES = 5000 / TIME_SCALE;
+
+// A tick needs at least one cycle, and a scale that does not divide 5000
+// would round TICK_CYCLES down and shift every period, so stop the
+// simulation at time 0 for either.
+`ifndef SYNTHESIS
+initial begin
+    if (TIME_SCALE < 1 || TIME_SCALE > 5000 || 5000 % TIME_SCALE != 0)
+        $fatal(1, "timebase: TIME_SCALE %0d must divide 5000", TIME_SCALE);
+end
+`endif
+
+reg [12:0] ctr;
+
+assign tick = (ctr == TICK_CYCLES - 13'd1);
+
+always @(posedge clk) begin
+    if (game_rst || sys_rst || tick)
+        ctr <= 13'd0;
+    else
+        ctr <= ctr + 13'd1;
+end
+
+endmodule
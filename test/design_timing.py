@@ -0,0 +1,58 @@
+# SPDX-FileCopyrightText: © 2024 Tiny Tapeout
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Line, frame and tick lengths of the design under test.
+
+Each value is read from the design's parameters where the simulator
+exposes them and otherwise falls back to the documented default for
+TIME_SCALE=1 and REDUCED_BLANKING=0 (800x525 raster, 5000-cycle tick,
+25000 ticks per speed level). design_timing() then measures a line and a
+tick on the running design, so a build with other parameters fails there
+instead of partway through a test. Line and frame lengths both follow
+REDUCED_BLANKING, so the measured line guards the frame length too.
+"""
+
+from collections import namedtuple
+
+from cocotb.triggers import RisingEdge
+
+Timing = namedtuple("Timing", "h_total v_total frame_cycles tick_cycles speed_up_interval")
+
+
+def param(handle, name, default):
+    """Value of a parameter of handle, or default if it is not visible."""
+    try:
+        return int(getattr(handle, name).value)
+    except AttributeError:
+        return default
+
+
+async def cycles_between(dut, condition):
+    """Clock cycles from one cycle where condition() holds to the next."""
+    while not condition():
+        await RisingEdge(dut.clk)
+    n = 0
+    while True:
+        await RisingEdge(dut.clk)
+        n += 1
+        if condition():
+            return n
+
+
+async def design_timing(dut):
+    """Timing of dut.user_project, out of reset and running."""
+    top = dut.user_project
+    h_total = param(top.hvsync_gen, "H_MAX", 799) + 1
+    v_total = param(top.hvsync_gen, "V_MAX", 524) + 1
+    t = Timing(h_total=h_total,
+               v_total=v_total,
+               frame_cycles=h_total * v_total,
+               tick_cycles=param(top.timebase_inst, "TICK_CYCLES", 5000),
+               speed_up_interval=param(top.game_ctrl, "SPEED_UP_INTERVAL", 25000))
+
+    line = await cycles_between(dut, lambda: int(top.hvsync_gen.hpos.value) == 0)
+    assert line == t.h_total, f"line is {line} cycles, expected {t.h_total}"
+    tick = await cycles_between(dut, lambda: int(top.timebase_inst.tick.value) == 1)
+    assert tick == t.tick_cycles, f"tick is {tick} cycles, expected {t.tick_cycles}"
+    return t
@@ -0,0 +1,91 @@
+# SPDX-FileCopyrightText: © 2024 Tiny Tapeout
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Gameplay tests for Goose Game.
+
+A real run takes minutes of simulated time before the first obstacle reaches
+the goose, so each test deposits the game state just before the event it
+checks (obstacle position, jump frame, speed timer) and then lets the RTL
+run for at most one frame. Uses internal hierarchy, so RTL only.
+"""
+
+import cocotb
+from cocotb.clock import Clock
+from cocotb.triggers import ClockCycles
+
+from design_timing import design_timing
+
+# obstacle_pos with the obstacle drawn over the goose (x 64..95)
+OBSTACLE_OVER_GOOSE = 620
+
+UI_IDLE = 0xFF
+UI_JUMP = 0xFE   # ui_in[0] low
+UI_RESET = 0xFD  # ui_in[1] low
+
+
+async def start(dut):
+    """Start the clock, reset the design with no buttons pressed and return
+    the design and its timing."""
+    clock = Clock(dut.clk, 40, units="ns")
+    cocotb.start_soon(clock.start())
+
+    dut.ena.value = 1
+    dut.ui_in.value = UI_IDLE
+    dut.uio_in.value = 0
+    dut.rst_n.value = 0
+    await ClockCycles(dut.clk, 10)
+    dut.rst_n.value = 1
+    await ClockCycles(dut.clk, 2)
+    return dut.user_project, await design_timing(dut)
+
+
+async def press(dut, ui_in, cycles=4):
+    dut.ui_in.value = ui_in
+    await ClockCycles(dut.clk, cycles)
+    dut.ui_in.value = UI_IDLE
+    await ClockCycles(dut.clk, 2)
+
+
+@cocotb.test()
+async def test_collision_sets_game_over(dut):
+    """An obstacle over the grounded goose ends the game within one frame."""
+    top, timing = await start(dut)
+    assert top.game_ctrl.game_over.value == 0, "game_over set after reset"
+
+    top.game_ctrl.obstacle_pos.value = OBSTACLE_OVER_GOOSE
+    await ClockCycles(dut.clk, timing.frame_cycles)
+    assert top.game_ctrl.game_over.value == 1, "collision did not set game_over"
+
+
+@cocotb.test()
+async def test_jump_clears_obstacle(dut):
+    """A goose near the top of its jump passes over the obstacle."""
+    top, timing = await start(dut)
+
+    await press(dut, UI_JUMP)
+    assert top.jumping_inst.in_air.value == 1, "jump button did not start a jump"
+
+    # Skip ahead to near the top of the jump, then bring in the obstacle
+    top.jumping_inst.frame.value = 20
+    await ClockCycles(dut.clk, 2)
+    top.game_ctrl.obstacle_pos.value = OBSTACLE_OVER_GOOSE
+    await ClockCycles(dut.clk, timing.frame_cycles)
+
+    assert top.jumping_inst.jump_pos.value > 90, "goose is not high in the air"
+    assert top.game_ctrl.game_over.value == 0, "goose collided while jumping"
+
+
+@cocotb.test()
+async def test_reset_clears_speed_level(dut):
+    """The speed timer raises speed_level and the reset button clears it."""
+    top, timing = await start(dut)
+
+    top.game_ctrl.speed_timer.value = timing.speed_up_interval - 1
+    await ClockCycles(dut.clk, timing.tick_cycles + 10)
+    assert top.game_ctrl.speed_level.value == 1, "speed timer did not step speed_level"
+    assert top.scroll_inst.period_out.value == 19, "scroll period did not follow speed_level"
+
+    await press(dut, UI_RESET)
+    assert top.game_ctrl.speed_level.value == 0, "reset button did not clear speed_level"
+    assert top.game_ctrl.game_over.value == 0, "reset button left game_over set"
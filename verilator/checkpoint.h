@@ -0,0 +1,173 @@
+/*
+ * Model checkpoint and restore.
+ *
+ * A checkpoint is the complete state of a --savable model (every register,
+ * the VGA counters, speed_timer, the jump frame and counter, the inputs)
+ * plus the harness cycle count, held in memory and optionally written to
+ * a file. Restoring puts a freshly constructed model of the same build
+ * into exactly that state, so a job can start at speed_level 6 with the
+ * obstacle approaching instead of simulating the lead-in.
+ *
+ * Layout, in memory and on disk:
+ *   "GGCKPT01", u64 cycle, u32 TIME_SCALE, u32 REDUCED_BLANKING
+ *   (little-endian), then the Verilator serialization of the
+ *   VerilatedContext and model
+ * A checkpoint only restores into a model built from the same RTL with
+ * the same Verilator; the parameter check catches the common mismatch.
+ *
+ * Models built without --savable (SIM_SAVABLE unset) report an error
+ * instead.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "goosegame_sim.h"
+#if SIM_SAVABLE
+#include "verilated_save.h"
+#endif
+
+#define CHECKPOINT_MAGIC "GGCKPT01"
+#define CHECKPOINT_HEADER_BYTES 24
+// Bytes handed to the Verilator reader per fill, above its block size
+#define CHECKPOINT_FILL_BYTES (64 * 1024)
+
+struct Checkpoint {
+  std::vector<uint8_t> data;
+  uint64_t cycle = 0;  // design cycles since reset when taken
+};
+
+#if SIM_SAVABLE
+// Verilator serializer that appends to a byte vector
+class CheckpointWriter : public VerilatedSerialize {
+ public:
+  explicit CheckpointWriter(std::vector<uint8_t>* out) : out_(out) { m_isOpen = true; }
+  ~CheckpointWriter() override { flush(); }
+
+  void flush() override {
+    out_->insert(out_->end(), m_bufp, m_cp);
+    m_cp = m_bufp;
+  }
+
+ private:
+  std::vector<uint8_t>* out_;
+};
+
+// Verilator deserializer that reads from a byte range
+class CheckpointReader : public VerilatedDeserialize {
+ public:
+  CheckpointReader(const uint8_t* data, size_t size) : src_(data), end_(data + size) {
+    m_isOpen = true;
+    m_cp = m_bufp;
+    m_endp = m_bufp;
+    fill();
+  }
+
+ protected:
+  // Keep the unread bytes, then top the buffer up from the source
+  void fill() override {
+    size_t keep = m_endp - m_cp;
+    memmove(m_bufp, m_cp, keep);
+    m_cp = m_bufp;
+    m_endp = m_bufp + keep;
+    size_t n = (size_t)(end_ - src_);
+    if (n > CHECKPOINT_FILL_BYTES) n = CHECKPOINT_FILL_BYTES;
+    memcpy(m_endp, src_, n);
+    m_endp += n;
+    src_ += n;
+  }
+
+ private:
+  const uint8_t* src_;
+  const uint8_t* end_;
+};
+#endif
+
+static inline void checkpoint_put64(uint8_t* p, uint64_t v) {
+  for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint64_t checkpoint_get64(const uint8_t* p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+  return v;
+}
+
+static inline bool checkpoint_save(VerilatedContext* contextp, Vtt_um_goose_game* top,
+                                   uint64_t cycle, Checkpoint* ckpt) {
+#if SIM_SAVABLE
+  ckpt->cycle = cycle;
+  ckpt->data.assign(CHECKPOINT_HEADER_BYTES, 0);
+  memcpy(ckpt->data.data(), CHECKPOINT_MAGIC, 8);
+  checkpoint_put64(&ckpt->data[8], cycle);
+  checkpoint_put64(&ckpt->data[16], SIM_TIME_SCALE | (uint64_t)SIM_REDUCED_BLANKING << 32);
+  CheckpointWriter os(&ckpt->data);
+  os << contextp << *top;
+  os.flush();
+  return true;
+#else
+  (void)contextp;
+  (void)top;
+  (void)cycle;
+  (void)ckpt;
+  fprintf(stderr, "checkpoint: model built without --savable\n");
+  return false;
+#endif
+}
+
+// Restore into a model of the same build, constructed but not yet reset
+static inline bool checkpoint_restore(VerilatedContext* contextp, Vtt_um_goose_game* top,
+                                      const Checkpoint& ckpt) {
+#if SIM_SAVABLE
+  if (ckpt.data.size() < CHECKPOINT_HEADER_BYTES ||
+      memcmp(ckpt.data.data(), CHECKPOINT_MAGIC, 8) != 0) {
+    fprintf(stderr, "checkpoint: not a goosegame checkpoint\n");
+    return false;
+  }
+  uint64_t params = checkpoint_get64(&ckpt.data[16]);
+  uint64_t time_scale = params & 0xFFFFFFFFu;
+  uint64_t reduced_blanking = params >> 32;
+  if (time_scale != SIM_TIME_SCALE || reduced_blanking != SIM_REDUCED_BLANKING) {
+    fprintf(stderr, "checkpoint: taken with TIME_SCALE=%llu REDUCED_BLANKING=%llu, this model has %d %d\n",
+            (unsigned long long)time_scale, (unsigned long long)reduced_blanking, SIM_TIME_SCALE,
+            SIM_REDUCED_BLANKING);
+    return false;
+  }
+  CheckpointReader os(ckpt.data.data() + CHECKPOINT_HEADER_BYTES,
+                      ckpt.data.size() - CHECKPOINT_HEADER_BYTES);
+  os >> contextp >> *top;
+  return true;
+#else
+  (void)contextp;
+  (void)top;
+  (void)ckpt;
+  fprintf(stderr, "checkpoint: model built without --savable\n");
+  return false;
+#endif
+}
+
+static inline bool checkpoint_write(const char* path, const Checkpoint& ckpt) {
+  FILE* f = fopen(path, "wb");
+  if (f == nullptr) return false;
+  bool ok = fwrite(ckpt.data.data(), 1, ckpt.data.size(), f) == ckpt.data.size();
+  return fclose(f) == 0 && ok;
+}
+
+static inline bool checkpoint_read(const char* path, Checkpoint* ckpt) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) return false;
+  ckpt->data.clear();
+  uint8_t buf[64 * 1024];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) ckpt->data.insert(ckpt->data.end(), buf, buf + n);
+  fclose(f);
+  if (ckpt->data.size() < CHECKPOINT_HEADER_BYTES) return false;
+  ckpt->cycle = checkpoint_get64(&ckpt->data[8]);
+  return true;
+}
+
+#endif
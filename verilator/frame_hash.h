@@ -0,0 +1,120 @@
+/*
+ * Per-frame hash stream for golden-trace comparison.
+ *
+ * Each captured frame is reduced to one text line:
+ *   <frame> <pixel hash, 16 hex digits> <game_over> <speed_level>
+ *   <obstacle_pos> <jump_pos> <scrolladdr>
+ * so a whole replay fits in a small file that diffs cleanly between RTL
+ * revisions. The frame that first differs can be written out as a PPM.
+ *
+ * v3 adds the obstacle, jump and scroll positions to each line. v2 had
+ * only game_over and speed_level, and v1 hashed ARGB8888 instead of the
+ * indexed pixels (pmod_decode.h); frame_hash_header_ok() rejects both.
+ */
+
+#ifndef FRAME_HASH_H
+#define FRAME_HASH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "goosegame_sim.h"
+#include "pmod_decode.h"
+
+#define FRAME_HASH_HEADER "# goosegame frame hashes v3"
+
+// 64-bit multiply/rotate hash over the indexed pixels, eight per step
+static inline uint64_t frame_hash64(const uint8_t* pixels, size_t count) {
+  const uint64_t k1 = 0x9E3779B97F4A7C15ull;
+  const uint64_t k2 = 0xBF58476D1CE4E5B9ull;
+  uint64_t h = k1 ^ count;
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    uint64_t w;
+    memcpy(&w, pixels + i, sizeof(w));
+    h ^= w * k1;
+    h = ((h << 31) | (h >> 33)) * k2;
+  }
+  for (; i < count; i++) h = (h ^ (pixels[i] * k1)) * k2;
+  h ^= h >> 30;
+  h *= k2;
+  h ^= h >> 27;
+  return h;
+}
+
+struct FrameRecord {
+  uint64_t frame;
+  uint64_t pixels;
+  int game_over;
+  int speed_level;
+  int obstacle_pos;
+  int jump_pos;
+  int scrolladdr;
+
+  bool operator==(const FrameRecord& o) const {
+    return frame == o.frame && pixels == o.pixels &&
+           game_over == o.game_over && speed_level == o.speed_level &&
+           obstacle_pos == o.obstacle_pos && jump_pos == o.jump_pos &&
+           scrolladdr == o.scrolladdr;
+  }
+  bool operator!=(const FrameRecord& o) const { return !(*this == o); }
+};
+
+static inline FrameRecord frame_record(Vtt_um_goose_game* top, uint64_t frame,
+                                       const uint8_t* pixels, size_t count) {
+  FrameRecord r;
+  r.frame = frame;
+  r.pixels = frame_hash64(pixels, count);
+  r.game_over = SIM_GAME_OVER(top);
+  r.speed_level = SIM_SPEED_LEVEL(top);
+  r.obstacle_pos = SIM_OBSTACLE_POS(top);
+  r.jump_pos = SIM_JUMP_POS(top);
+  r.scrolladdr = SIM_SCROLLADDR(top);
+  return r;
+}
+
+static inline void frame_record_write(FILE* f, const FrameRecord& r) {
+  fprintf(f, "%llu %016llx %d %d %d %d %d\n", (unsigned long long)r.frame,
+          (unsigned long long)r.pixels, r.game_over, r.speed_level, r.obstacle_pos, r.jump_pos,
+          r.scrolladdr);
+}
+
+// Read the header line of a hash stream, false unless it is this version
+static inline bool frame_hash_header_ok(FILE* f) {
+  char line[128];
+  if (fgets(line, sizeof(line), f) == nullptr) return false;
+  line[strcspn(line, "\r\n")] = 0;
+  return strcmp(line, FRAME_HASH_HEADER) == 0;
+}
+
+// Next record of a hash stream; false at end of file or on a bad line
+static inline bool frame_record_read(FILE* f, FrameRecord* r) {
+  char line[128];
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    if (line[0] == '#') continue;
+    unsigned long long frame, pixels;
+    if (sscanf(line, "%llu %llx %d %d %d %d %d", &frame, &pixels, &r->game_over, &r->speed_level,
+               &r->obstacle_pos, &r->jump_pos, &r->scrolladdr) != 7) {
+      return false;
+    }
+    r->frame = frame;
+    r->pixels = pixels;
+    return true;
+  }
+  return false;
+}
+
+// Write an indexed frame as a binary PPM image
+static inline bool write_ppm(const char* path, const uint8_t* pixels, int width, int height) {
+  FILE* f = fopen(path, "wb");
+  if (f == nullptr) return false;
+  fprintf(f, "P6\n%d %d\n255\n", width, height);
+  for (int i = 0; i < width * height; i++) {
+    uint32_t argb = pmod_argb(pixels[i]);
+    uint8_t rgb[3] = {(uint8_t)(argb >> 16), (uint8_t)(argb >> 8), (uint8_t)argb};
+    fwrite(rgb, 1, sizeof(rgb), f);
+  }
+  return fclose(f) == 0;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Frame hand-off between the simulation thread and the display thread.
+ *
+ * A lock-free triple buffer: the simulation always has a buffer to fill,
+ * the display always picks up the newest completed frame, and neither side
+ * ever waits for the other. Frames the display was too slow to pick up are
+ * overwritten and counted as dropped.
+ */
+
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+struct VideoFrame {
+  std::vector<uint8_t> pixels;  // palette indices, see pmod_decode.h
+  int width = 0;
+  int height = 0;
+  uint64_t number = 0;
+  uint64_t start_cycle = 0;  // design cycle the frame began at
+  // Capture frame index, and per row the index it last changed in (see
+  // VgaCapture::row_version). Rows newer than the frame on screen are dirty.
+  uint64_t version = 0;
+  std::vector<uint64_t> row_version;
+
+  void resize(int w, int h) {
+    width = w;
+    height = h;
+    pixels.resize((size_t)w * h);
+    row_version.resize(h);
+  }
+};
+
+class FrameQueue {
+ public:
+  // Producer side: buffer to fill next, then hand it over with publish()
+  VideoFrame& back() { return frames_[back_]; }
+
+  void publish() {
+    int prev = ready_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+    if (prev & FRESH) dropped_.fetch_add(1, std::memory_order_relaxed);
+    back_ = prev & INDEX_MASK;
+  }
+
+  // Consumer side: newest completed frame, or nullptr if nothing new has
+  // been published since the last call. Valid until the next acquire().
+  const VideoFrame* acquire() {
+    if ((ready_.load(std::memory_order_acquire) & FRESH) == 0) return nullptr;
+    front_ = ready_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+    return &frames_[front_];
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  static const int INDEX_MASK = 0x3;
+  static const int FRESH = 0x4;
+
+  VideoFrame frames_[3];
+  int back_ = 0;
+  int front_ = 1;
+  std::atomic<int> ready_{2};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+#endif
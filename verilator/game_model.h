@@ -0,0 +1,372 @@
+/*
+ * Hand-written C++ model of the game logic.
+ *
+ * Mirrors game_controller.v, scroll.v, jumping.v, timebase.v and the
+ * collision rule of rendering.v register for register, including their
+ * quirks (the speed timer still counting when a tick lands on the
+ * reset-button cycle). It does not produce pixels.
+ *
+ * The model is not clocked per cycle. Between events every register is
+ * either constant or a counter counting up, so advance() skips straight to
+ * the next cycle where something else changes: a scroll step, the
+ * obstacle following it, a jump frame, a speed-up, a button edge, or the
+ * raster reaching a pixel where the goose and the obstacle both draw.
+ * Timebase ticks in between only advance the tick counters and are
+ * skipped too. Only event cycles are evaluated one at a time, a few
+ * hundred per frame.
+ *
+ * Cycle 0 is the first cycle after sim_reset(), so after advance(n) the
+ * model matches the RTL after sim_tick(n) with the same ui_in.
+ */
+
+#ifndef GAME_MODEL_H
+#define GAME_MODEL_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+// tt_um_goose_game TIME_SCALE the RTL was built with, see the Makefile
+#ifndef SIM_TIME_SCALE
+#define SIM_TIME_SCALE 1
+#endif
+// timebase.v refuses the same scales: the tick must be at least one cycle
+// and a whole 5000 / SIM_TIME_SCALE
+#if SIM_TIME_SCALE < 1 || SIM_TIME_SCALE > 5000 || 5000 % SIM_TIME_SCALE != 0
+#error "SIM_TIME_SCALE must divide 5000"
+#endif
+
+// tt_um_goose_game REDUCED_BLANKING, which sets the raster the collision
+// check runs on
+#ifndef SIM_REDUCED_BLANKING
+#define SIM_REDUCED_BLANKING 0
+#endif
+
+#if SIM_REDUCED_BLANKING
+#define MODEL_H_TOTAL 643
+#define MODEL_FRAME_CYCLES (643 * 483)
+#else
+#define MODEL_H_TOTAL 800
+#define MODEL_FRAME_CYCLES (800 * 525)
+#endif
+#define MODEL_H_DISPLAY 640
+#define MODEL_V_DISPLAY 480
+
+class GameModel {
+ public:
+  explicit GameModel(uint32_t time_scale = SIM_TIME_SCALE)
+      : tick_cycles_(tick_cycles_for(time_scale)) {
+    reset();
+  }
+
+  // State after the system reset (rst_n low for one cycle)
+  void reset() {
+    cycle_ = 0;
+    tick_ctr_ = 0;
+    game_over_ = false;
+    speed_level_ = 0;
+    speed_timer_ = 0;
+    reset_button_prev_ = false;
+    obstacle_pos_ = 0;
+    scrolladdr_prev_ = 0;
+    scroll_pos_ = 0;
+    scroll_ctr_ = 0;
+    jump_ctr_ = 0;
+    jump_frame_ = 0;
+    in_air_ = false;
+    jump_pos_ = 0;
+    collision_ = false;
+    exact_ticks_ = 0;
+  }
+
+  // Advance by a number of design cycles with ui_in held constant
+  void advance(uint64_t cycles, uint8_t ui_in) {
+    bool jump = (ui_in & 0x01) == 0;
+    bool reset_button = (ui_in & 0x02) == 0;
+    while (cycles > 0) {
+      uint64_t quiet = quiet_ticks(jump, reset_button);
+      if (quiet == 0) {
+        tick(jump, reset_button);
+        cycles--;
+        continue;
+      }
+      uint64_t n = quiet < cycles ? quiet : cycles;
+      skip(n);
+      cycles -= n;
+    }
+  }
+
+  // Advance to the end of the current frame
+  void advance_frame(uint8_t ui_in) {
+    advance(MODEL_FRAME_CYCLES - cycle_ % MODEL_FRAME_CYCLES, ui_in);
+  }
+
+  uint64_t cycle() const { return cycle_; }
+  bool game_over() const { return game_over_; }
+  uint8_t speed_level() const { return speed_level_; }
+  uint16_t obstacle_pos() const { return obstacle_pos_; }
+  uint8_t jump_pos() const { return jump_pos_; }
+  uint16_t scrolladdr() const { return scroll_pos_; }
+  // Cycles evaluated one at a time so far, the rest were skipped
+  uint64_t exact_ticks() const { return exact_ticks_; }
+
+ private:
+  static const uint32_t OBSTACLE_CYCLE = 700;
+  static const uint32_t JUMP_FRAMES = 50;
+  // Timebase ticks per speed level
+  static const uint32_t SPEED_UP_INTERVAL = 25000;
+
+  // timebase.v TICK_CYCLES; like the RTL, only divisors of 5000 are taken
+  static uint32_t tick_cycles_for(uint32_t time_scale) {
+    assert(time_scale >= 1 && time_scale <= 5000 && 5000 % time_scale == 0);
+    return 5000 / time_scale;
+  }
+
+  // scroll.v, in timebase ticks
+  uint32_t scroll_period() const {
+    static const uint8_t periods[8] = {22, 19, 16, 13, 10, 7, 4, 2};
+    return periods[speed_level_];
+  }
+
+  // Cycles from now to the tick after n more ticks (n = 0: the next one)
+  uint64_t ticks_away(uint32_t n) const {
+    return (uint64_t)(tick_cycles_ - 1 - tick_ctr_) + (uint64_t)n * tick_cycles_;
+  }
+
+  uint8_t jump_table() const {
+    static const uint8_t y_table[26] = {0,  8,  16, 23, 30, 36, 43, 49, 56,  61,  66,  70,  75,
+                                        79, 83, 87, 90, 92, 95, 98, 99, 100, 101, 103, 103, 104};
+    uint32_t idx = jump_frame_ <= 25 ? jump_frame_ : ((50 - jump_frame_) & 31);
+    return y_table[idx];
+  }
+
+  // rendering.v: both the goose and the obstacle layer are set at this
+  // raster position. Only opacity matters, so the ROMs are kept as masks.
+  bool collision_at(uint32_t h, uint32_t v) const {
+    // goose_rom, bit n = pixel n of the row is not transparent
+    static const uint16_t goose_mask[16] = {
+        0x0000, 0x0000, 0x7c00, 0xfc00, 0xfc00, 0xfc00, 0x1c00, 0x1c00,
+        0x1c00, 0x1c00, 0x1ffc, 0x1ffc, 0x1ffc, 0x1ffc, 0x1ffc, 0x0630,
+    };
+    // emblem_rom at 2x: screen rows 0-31 are fully opaque, then the shield
+    // tapers two pixels per side every two rows
+    static const uint64_t emblem_mask_tail[16] = {
+        0x3ffffffffcull, 0x3ffffffffcull, 0x0ffffffff0ull, 0x0ffffffff0ull,
+        0x03ffffffc0ull, 0x03ffffffc0ull, 0x00ffffff00ull, 0x00ffffff00ull,
+        0x003ffffc00ull, 0x003ffffc00ull, 0x000ffff000ull, 0x000ffff000ull,
+        0x0003ffc000ull, 0x0003ffc000ull, 0x0000ff0000ull, 0x0000ff0000ull,
+    };
+    if (h >= MODEL_H_DISPLAY || v >= MODEL_V_DISPLAY) return false;
+
+    uint32_t goose_y = 208 - jump_pos_;
+    if ((h >> 5) != 2 || v < goose_y || v >= goose_y + 32) return false;
+    uint32_t goose_row = ((v >> 1) - (goose_y >> 1)) & 15;
+    if (((goose_mask[goose_row] >> ((h >> 1) & 15)) & 1) == 0) return false;
+
+    uint32_t obstacle_x = (640 - obstacle_pos_ + 50) & 2047;
+    uint32_t obstacle_right = (obstacle_x + 40) & 2047;
+    if (h < obstacle_x || h >= obstacle_right || v < 192 || v >= 240) return false;
+    uint32_t emblem_row = (v - 192) & 63;
+    if (emblem_row < 32) return true;
+    return ((emblem_mask_tail[emblem_row - 32] >> ((h - obstacle_x) & 63)) & 1) != 0;
+  }
+
+  // Cycles from now until the raster reaches an overlapping pixel, for the
+  // current obstacle and jump positions
+  uint64_t ticks_to_overlap() {
+    uint32_t key = ((uint32_t)obstacle_pos_ << 8) | jump_pos_;
+    if (key != overlap_key_) {
+      overlap_key_ = key;
+      overlaps_.clear();
+      uint32_t goose_y = 208 - jump_pos_;
+      for (uint32_t v = goose_y > 192 ? goose_y : 192; v < goose_y + 32 && v < 240; v++) {
+        for (uint32_t h = 64; h < 96; h++) {
+          if (collision_at(h, v)) overlaps_.push_back(v * MODEL_H_TOTAL + h);
+        }
+      }
+    }
+    if (overlaps_.empty()) return UINT64_MAX;
+    uint32_t phase = (uint32_t)(cycle_ % MODEL_FRAME_CYCLES);
+    for (uint32_t offset : overlaps_) {
+      if (offset >= phase) return offset - phase;
+    }
+    return overlaps_.front() + MODEL_FRAME_CYCLES - phase;
+  }
+
+  // Number of cycles from now in which only the counters count (timebase,
+  // and on ticks the speed timer, scroll counter and jump counter); 0 when
+  // the next cycle has to be evaluated exactly
+  uint64_t quiet_ticks(bool jump, bool reset_button) {
+    if (reset_button != reset_button_prev_ || jump_pos_ != jump_table()) return 0;
+    if (game_over_) return UINT64_MAX;  // halted until the reset button
+    if (collision_ || scroll_pos_ != scrolladdr_prev_) return 0;
+
+    // Ticks before the one that steps each counter past its period
+    uint32_t period = scroll_period();
+    uint32_t ticks = speed_timer_ + 1 >= SPEED_UP_INTERVAL ? 0 : SPEED_UP_INTERVAL - 1 - speed_timer_;
+    uint32_t to_step = scroll_ctr_ + 1 >= period ? 0 : period - 1 - scroll_ctr_;
+    if (to_step < ticks) ticks = to_step;
+    if (in_air_) {
+      uint32_t frame_ticks = period << 1;
+      uint32_t to_frame = jump_ctr_ + 1 >= frame_ticks ? 0 : frame_ticks - 1 - jump_ctr_;
+      if (to_frame < ticks) ticks = to_frame;
+    }
+    else if (jump) {
+      return 0;
+    }
+    uint64_t quiet = ticks_away(ticks);
+    uint64_t to_overlap = ticks_to_overlap();
+    return to_overlap < quiet ? to_overlap : quiet;
+  }
+
+  void skip(uint64_t n) {
+    uint64_t to_tick = tick_cycles_ - 1 - tick_ctr_;
+    uint32_t ticks = n > to_tick ? (uint32_t)((n - 1 - to_tick) / tick_cycles_ + 1) : 0;
+    tick_ctr_ = (uint32_t)((tick_ctr_ + n) % tick_cycles_);
+    if (!game_over_) {
+      speed_timer_ += ticks;
+      scroll_ctr_ += ticks;
+      if (in_air_) jump_ctr_ += ticks;
+    }
+    cycle_ += n;
+    uint32_t last = (uint32_t)((cycle_ - 1) % MODEL_FRAME_CYCLES);
+    collision_ = collision_at(last % MODEL_H_TOTAL, last / MODEL_H_TOTAL);
+  }
+
+  // One clock edge, every register computed from the values before it
+  void tick(bool jump, bool reset_button) {
+    bool game_reset = reset_button && !reset_button_prev_;
+    bool on_tick = tick_ctr_ == tick_cycles_ - 1;
+    uint32_t period = scroll_period();
+    uint32_t phase = (uint32_t)(cycle_ % MODEL_FRAME_CYCLES);
+    bool collision = collision_at(phase % MODEL_H_TOTAL, phase / MODEL_H_TOTAL);
+
+    // timebase.v
+    uint32_t tick_ctr = game_reset || on_tick ? 0 : tick_ctr_ + 1;
+
+    // game_controller.v
+    uint16_t obstacle_pos = obstacle_pos_;
+    uint16_t scrolladdr_prev = scrolladdr_prev_;
+    if (game_reset) {
+      obstacle_pos = 0;
+      scrolladdr_prev = 0;
+    }
+    else if (!game_over_ && scroll_pos_ != scrolladdr_prev_) {
+      scrolladdr_prev = scroll_pos_;
+      obstacle_pos = obstacle_pos_ >= OBSTACLE_CYCLE - 1 ? 0 : obstacle_pos_ + 1;
+    }
+
+    bool game_over = game_over_;
+    uint8_t speed_level = speed_level_;
+    uint32_t speed_timer = speed_timer_;
+    if (game_reset) {
+      game_over = false;
+      speed_level = 0;
+      speed_timer = 0;
+    }
+    else if (collision_ && !game_over_) {
+      game_over = true;
+    }
+    if (!game_over_ && on_tick) {
+      speed_timer = speed_timer_ + 1;
+      if (speed_timer_ >= SPEED_UP_INTERVAL - 1) {
+        if (speed_level_ < 7) speed_level = speed_level_ + 1;
+        speed_timer = 0;
+      }
+    }
+
+    // scroll.v
+    uint16_t scroll_pos = scroll_pos_;
+    uint32_t scroll_ctr = scroll_ctr_;
+    if (game_reset) {
+      scroll_pos = 0;
+      scroll_ctr = 0;
+    }
+    else if (!game_over_ && on_tick) {
+      if (scroll_ctr_ >= period - 1) {
+        scroll_ctr = 0;
+        scroll_pos = (scroll_pos_ + 2) & 1023;
+      }
+      else {
+        scroll_ctr = scroll_ctr_ + 1;
+      }
+    }
+
+    // jumping.v
+    uint32_t jump_ctr = jump_ctr_;
+    uint8_t jump_frame = jump_frame_;
+    bool in_air = in_air_;
+    uint8_t jump_pos = jump_pos_;
+    if (game_reset) {
+      jump_ctr = 0;
+      jump_frame = 0;
+      in_air = false;
+      jump_pos = 0;
+    }
+    else {
+      jump_pos = jump_table();
+      if (!game_over_) {
+        if (in_air_ && on_tick) {
+          jump_ctr = jump_ctr_ + 1;
+          if (jump_ctr_ >= (period << 1) - 1) {
+            jump_ctr = 0;
+            jump_frame = jump_frame_ + 1;
+            if (jump_frame >= JUMP_FRAMES) {
+              jump_frame = 0;
+              in_air = false;
+            }
+          }
+        }
+        else if (!in_air_ && jump) {
+          in_air = true;
+        }
+      }
+    }
+
+    tick_ctr_ = tick_ctr;
+    obstacle_pos_ = obstacle_pos;
+    scrolladdr_prev_ = scrolladdr_prev;
+    game_over_ = game_over;
+    speed_level_ = speed_level;
+    speed_timer_ = speed_timer;
+    reset_button_prev_ = reset_button;
+    scroll_pos_ = scroll_pos;
+    scroll_ctr_ = scroll_ctr;
+    jump_ctr_ = jump_ctr;
+    jump_frame_ = jump_frame;
+    in_air_ = in_air;
+    jump_pos_ = jump_pos;
+    collision_ = collision;
+    cycle_++;
+    exact_ticks_++;
+  }
+
+  uint32_t tick_cycles_;
+
+  uint64_t cycle_;
+  // timebase
+  uint32_t tick_ctr_;
+  // game_controller
+  bool game_over_;
+  uint8_t speed_level_;
+  uint32_t speed_timer_;
+  bool reset_button_prev_;
+  uint16_t obstacle_pos_;
+  uint16_t scrolladdr_prev_;
+  // scroll
+  uint16_t scroll_pos_;
+  uint32_t scroll_ctr_;
+  // jumping
+  uint32_t jump_ctr_;
+  uint8_t jump_frame_;
+  bool in_air_;
+  uint8_t jump_pos_;
+  // rendering: goose and obstacle layers both set, registered
+  bool collision_;
+
+  uint64_t exact_ticks_;
+  uint32_t overlap_key_ = UINT32_MAX;
+  std::vector<uint32_t> overlaps_;
+};
+
+#endif
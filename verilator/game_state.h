@@ -0,0 +1,147 @@
+/*
+ * Typed game state and per-frame telemetry.
+ *
+ * GameState is a snapshot of the registers marked public in the RTL, read
+ * straight from the model so harnesses can check the game without decoding
+ * pixels. TelemetryLog writes one snapshot per frame, as CSV or as compact
+ * little-endian binary records:
+ *   header  "GGTELEM1"
+ *   record  u64 cycle, u32 frame, u16 obstacle_pos, u16 scrolladdr,
+ *           u8 jump_pos, u8 speed_level, u8 game_over, u8 reserved (20 bytes)
+ *
+ * Lockstep runs the C++ game model (game_model.h) next to the RTL and
+ * compares the two snapshots at the end of every frame.
+ */
+
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "goosegame_sim.h"
+#include "game_model.h"
+
+#define TELEMETRY_MAGIC "GGTELEM1"
+#define TELEMETRY_RECORD_BYTES 20
+#define TELEMETRY_CSV_HEADER "frame,cycle,game_over,speed_level,obstacle_pos,jump_pos,scrolladdr"
+
+struct GameState {
+  bool game_over;
+  uint8_t speed_level;    // 0-7
+  uint16_t obstacle_pos;  // 10 bits
+  uint8_t jump_pos;       // 7 bits, height above the ground
+  uint16_t scrolladdr;    // 10 bits
+};
+
+static inline GameState game_state(const Vtt_um_goose_game* top) {
+  GameState s;
+  s.game_over = SIM_GAME_OVER(top) != 0;
+  s.speed_level = (uint8_t)SIM_SPEED_LEVEL(top);
+  s.obstacle_pos = (uint16_t)SIM_OBSTACLE_POS(top);
+  s.jump_pos = (uint8_t)SIM_JUMP_POS(top);
+  s.scrolladdr = (uint16_t)SIM_SCROLLADDR(top);
+  return s;
+}
+
+static inline GameState game_state(const GameModel& model) {
+  GameState s;
+  s.game_over = model.game_over();
+  s.speed_level = model.speed_level();
+  s.obstacle_pos = model.obstacle_pos();
+  s.jump_pos = model.jump_pos();
+  s.scrolladdr = model.scrolladdr();
+  return s;
+}
+
+class Lockstep {
+ public:
+  // Call with every stretch of cycles the RTL is clocked for
+  void advance(uint64_t cycles, uint8_t ui_in) { model_.advance(cycles, ui_in); }
+
+  // Compare at a frame end. The first divergence is reported on stderr and
+  // every later check fails without printing.
+  bool check(const Vtt_um_goose_game* top, uint64_t frame) {
+    if (diverged_) return false;
+    GameState rtl = game_state(top);
+    GameState model = game_state(model_);
+    diverged_ = rtl.game_over != model.game_over || rtl.speed_level != model.speed_level ||
+                rtl.obstacle_pos != model.obstacle_pos || rtl.jump_pos != model.jump_pos ||
+                rtl.scrolladdr != model.scrolladdr;
+    if (!diverged_) return true;
+    fprintf(stderr, "lockstep: model diverged at the end of frame %llu (cycle %llu)\n",
+            (unsigned long long)frame, (unsigned long long)model_.cycle());
+    fprintf(stderr, "  %-13s %6s %6s\n", "", "rtl", "model");
+    fprintf(stderr, "  %-13s %6d %6d\n", "game_over", rtl.game_over, model.game_over);
+    fprintf(stderr, "  %-13s %6d %6d\n", "speed_level", rtl.speed_level, model.speed_level);
+    fprintf(stderr, "  %-13s %6d %6d\n", "obstacle_pos", rtl.obstacle_pos, model.obstacle_pos);
+    fprintf(stderr, "  %-13s %6d %6d\n", "jump_pos", rtl.jump_pos, model.jump_pos);
+    fprintf(stderr, "  %-13s %6d %6d\n", "scrolladdr", rtl.scrolladdr, model.scrolladdr);
+    return false;
+  }
+
+  bool diverged() const { return diverged_; }
+  const GameModel& model() const { return model_; }
+
+ private:
+  GameModel model_;
+  bool diverged_ = false;
+};
+
+enum TelemetryFormat { TELEMETRY_CSV, TELEMETRY_BINARY };
+
+static inline bool telemetry_parse_format(const char* name, TelemetryFormat* format) {
+  if (strcmp(name, "csv") == 0) *format = TELEMETRY_CSV;
+  else if (strcmp(name, "bin") == 0) *format = TELEMETRY_BINARY;
+  else return false;
+  return true;
+}
+
+class TelemetryLog {
+ public:
+  ~TelemetryLog() { close(); }
+
+  bool open(const char* path, TelemetryFormat format) {
+    file_ = fopen(path, format == TELEMETRY_CSV ? "w" : "wb");
+    if (file_ == nullptr) return false;
+    format_ = format;
+    if (format_ == TELEMETRY_CSV) fprintf(file_, "%s\n", TELEMETRY_CSV_HEADER);
+    else fwrite(TELEMETRY_MAGIC, 1, strlen(TELEMETRY_MAGIC), file_);
+    return true;
+  }
+
+  bool is_open() const { return file_ != nullptr; }
+
+  void write(uint64_t frame, uint64_t cycle, const GameState& s) {
+    if (file_ == nullptr) return;
+    if (format_ == TELEMETRY_CSV) {
+      fprintf(file_, "%llu,%llu,%d,%d,%d,%d,%d\n", (unsigned long long)frame,
+              (unsigned long long)cycle, s.game_over, s.speed_level, s.obstacle_pos, s.jump_pos,
+              s.scrolladdr);
+      return;
+    }
+    uint8_t rec[TELEMETRY_RECORD_BYTES];
+    for (int i = 0; i < 8; i++) rec[i] = (uint8_t)(cycle >> (8 * i));
+    for (int i = 0; i < 4; i++) rec[8 + i] = (uint8_t)(frame >> (8 * i));
+    rec[12] = (uint8_t)s.obstacle_pos;
+    rec[13] = (uint8_t)(s.obstacle_pos >> 8);
+    rec[14] = (uint8_t)s.scrolladdr;
+    rec[15] = (uint8_t)(s.scrolladdr >> 8);
+    rec[16] = s.jump_pos;
+    rec[17] = s.speed_level;
+    rec[18] = s.game_over;
+    rec[19] = 0;
+    fwrite(rec, 1, sizeof(rec), file_);
+  }
+
+  void close() {
+    if (file_ != nullptr) fclose(file_);
+    file_ = nullptr;
+  }
+
+ private:
+  FILE* file_ = nullptr;
+  TelemetryFormat format_ = TELEMETRY_CSV;
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * Step/observe environment for bots and RL agents.
+ *
+ * GooseEnv wraps one headless model (own VerilatedContext) behind reset()
+ * and step(action, frames). A step holds the action's buttons for whole
+ * frames and stops early at game over. The observation is the game state
+ * registers (game_state.h) and, with EnvOptions::observe_pixels, the last
+ * frame downsampled by an integer factor. State-only envs are clocked in
+ * bulk like input_log_replay(); pixel envs sample uo_out every cycle.
+ *
+ * GooseEnvBatch owns B envs and steps them back to back on the calling
+ * thread, so a worker steps many environments per call. Give each worker
+ * thread its own batch.
+ *
+ * With randomize_phase, reset() starts the obstacle at a random point of
+ * its cycle (seeded per env) instead of the far right, so episodes reach
+ * the first obstacle after varying delays. With a start checkpoint
+ * (checkpoint.h) episodes begin from that state instead of from reset,
+ * e.g. late in the game at a high speed_level.
+ */
+
+#ifndef GOOSE_ENV_H
+#define GOOSE_ENV_H
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+#include "goosegame_sim.h"
+#include "vga_capture.h"
+#include "game_state.h"
+#include "checkpoint.h"
+
+// Random start phases stay clear of the goose (obstacle_pos 595-665)
+#define ENV_PHASE_LIMIT 560
+
+enum EnvAction {
+  ENV_NOOP,
+  ENV_JUMP,
+  ENV_ACTION_COUNT
+};
+
+struct EnvOptions {
+  bool observe_pixels = false;
+  int downsample = 8;  // 640x480 -> 80x60
+  bool randomize_phase = false;
+  uint64_t seed = 1;
+  const Checkpoint* start = nullptr;  // episodes start here instead of at reset
+  TelemetryLog* telemetry = nullptr;  // per-frame state of every step, optional
+};
+
+struct EnvStep {
+  GameState state;
+  uint64_t frame;  // frames since reset (or the start checkpoint)
+  int frames;      // frames actually stepped (fewer when done)
+  bool done;       // game over
+};
+
+class GooseEnv {
+ public:
+  explicit GooseEnv(const EnvOptions& opt) : opt_(opt), rng_(opt.seed) {
+    contextp_ = new VerilatedContext;
+    top_ = new Vtt_um_goose_game{contextp_};
+  }
+
+  ~GooseEnv() {
+    top_->final();
+    delete top_;
+    delete contextp_;
+  }
+
+  GooseEnv(const GooseEnv&) = delete;
+  GooseEnv& operator=(const GooseEnv&) = delete;
+
+  EnvStep reset() {
+    if (opt_.start == nullptr || !checkpoint_restore(contextp_, top_, *opt_.start)) sim_reset(top_);
+    if (opt_.randomize_phase) {
+      SIM_OBSTACLE_POS(top_) = std::uniform_int_distribution<int>(0, ENV_PHASE_LIMIT - 1)(rng_);
+    }
+    cycle_ = 0;
+    capture_.reset();
+    retarget();
+    observation_.clear();
+    observation_width_ = frame_width_ / opt_.downsample;
+    observation_height_ = frame_height_ / opt_.downsample;
+    EnvStep s = {game_state(top_), 0, 0, false};
+    return s;
+  }
+
+  EnvStep step(int action, int frames) {
+    top_->ui_in = make_ui_in(action == ENV_JUMP, false);
+    GameState state = game_state(top_);
+    EnvStep s = {state, cycle_ / FRAME_CYCLES, 0, state.game_over};
+    while (s.frames < frames && !s.done) {
+      if (opt_.observe_pixels) run_frame_sampled();
+      else sim_tick(top_, FRAME_CYCLES);
+      cycle_ += FRAME_CYCLES;
+      s.state = game_state(top_);
+      s.frame = cycle_ / FRAME_CYCLES;
+      s.frames++;
+      s.done = s.state.game_over;
+      if (opt_.telemetry != nullptr) opt_.telemetry->write(s.frame - 1, cycle_, s.state);
+    }
+    top_->ui_in = UI_IDLE;
+    return s;
+  }
+
+  // Last completed frame downsampled to observation_width() x
+  // observation_height() ARGB pixels; empty before the first full frame
+  const std::vector<uint32_t>& observation() const { return observation_; }
+  int observation_width() const { return observation_width_; }
+  int observation_height() const { return observation_height_; }
+
+  Vtt_um_goose_game* model() { return top_; }
+
+ private:
+  void run_frame_sampled() {
+    for (uint32_t i = 0; i < FRAME_CYCLES; i++) {
+      sim_tick(top_);
+      if (!capture_.sample(top_->uo_out)) continue;
+      // The frame was written with the previous window, which can move
+      // between frames while sync locks: sample it before adopting the new one
+      downsample();
+      retarget();
+    }
+  }
+
+  // Size pixels_ to the capture window and point the next frame at it
+  void retarget() {
+    frame_width_ = capture_.width();
+    frame_height_ = capture_.height();
+    pixels_.assign((size_t)frame_width_ * frame_height_, 0);
+    capture_.set_target(pixels_.data(), frame_width_);
+  }
+
+  // Nearest sample at the top left of every downsample x downsample block
+  void downsample() {
+    int f = opt_.downsample;
+    int w = frame_width_ / f;
+    int h = frame_height_ / f;
+    int pitch = frame_width_;
+    observation_width_ = w;
+    observation_height_ = h;
+    observation_.resize((size_t)w * h);
+    for (int y = 0; y < h; y++) {
+      const uint8_t* src = pixels_.data() + (size_t)y * f * pitch;
+      uint32_t* dst = observation_.data() + (size_t)y * w;
+      for (int x = 0; x < w; x++) dst[x] = pmod_argb(src[x * f]);
+    }
+  }
+
+  EnvOptions opt_;
+  std::mt19937_64 rng_;
+  VerilatedContext* contextp_;
+  Vtt_um_goose_game* top_;
+  uint64_t cycle_ = 0;
+  VgaCapture capture_;
+  std::vector<uint8_t> pixels_;  // indexed, see pmod_decode.h
+  int frame_width_ = 0;          // window pixels_ is being written with
+  int frame_height_ = 0;
+  std::vector<uint32_t> observation_;
+  int observation_width_ = 0;
+  int observation_height_ = 0;
+};
+
+class GooseEnvBatch {
+ public:
+  // Env i is seeded with opt.seed + i
+  GooseEnvBatch(size_t count, const EnvOptions& opt) {
+    for (size_t i = 0; i < count; i++) {
+      EnvOptions o = opt;
+      o.seed = opt.seed + i;
+      envs_.emplace_back(new GooseEnv(o));
+    }
+  }
+
+  ~GooseEnvBatch() {
+    for (GooseEnv* env : envs_) delete env;
+  }
+
+  GooseEnvBatch(const GooseEnvBatch&) = delete;
+  GooseEnvBatch& operator=(const GooseEnvBatch&) = delete;
+
+  size_t size() const { return envs_.size(); }
+  GooseEnv& env(size_t i) { return *envs_[i]; }
+
+  // out holds size() steps
+  void reset(EnvStep* out) {
+    for (size_t i = 0; i < envs_.size(); i++) out[i] = envs_[i]->reset();
+  }
+
+  // One action per env. out must hold the previous reset() or step()
+  // results: envs that were done are reset first, so a batch never stalls
+  // on a finished episode.
+  void step(const uint8_t* actions, int frames, EnvStep* out) {
+    for (size_t i = 0; i < envs_.size(); i++) {
+      if (out[i].done) envs_[i]->reset();
+      out[i] = envs_[i]->step(actions[i], frames);
+    }
+  }
+
+ private:
+  std::vector<GooseEnv*> envs_;
+};
+
+#endif
@@ -0,0 +1,269 @@
+/*
+ * Headless benchmark for the Verilated goose game model.
+ *
+ * Runs fixed input scenarios for a set number of frames without SDL and
+ * reports simulation speed as JSON. With --baseline, exits non-zero when
+ * any scenario is slower than the stored result by more than --tolerance.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "goosegame_sim.h"
+
+enum ScenarioId {
+  SCENARIO_IDLE,       // no input, game scrolls until it collides
+  SCENARIO_JUMP,       // press jump for one frame every N frames
+  SCENARIO_SPEED7,     // speed_level pinned at 7
+  SCENARIO_GAME_OVER,  // parked in game_over, nothing moves but VGA
+  SCENARIO_COUNT
+};
+
+static const char* const scenario_names[SCENARIO_COUNT] = {
+  "idle", "jump", "speed7", "game_over"
+};
+
+struct BenchOptions {
+  int frames = 120;
+  int jump_every = 30;
+  double tolerance = 0.10;
+  bool legacy_tick = false;
+  const char* baseline = nullptr;
+  const char* out = nullptr;
+  bool enabled[SCENARIO_COUNT] = {true, true, true, true};
+  int argc = 0;
+  char** argv = nullptr;
+};
+
+struct BenchResult {
+  const char* name;
+  unsigned threads;
+  uint64_t frames;
+  uint64_t cycles;
+  double seconds;
+  double cycles_per_sec;
+  double frames_per_sec;
+  double ns_per_eval;
+};
+
+static int scenario_by_name(const char* name) {
+  for (int i = 0; i < SCENARIO_COUNT; i++) {
+    if (strcmp(name, scenario_names[i]) == 0) return i;
+  }
+  return -1;
+}
+
+// Per-frame input for a scenario. Outside game_over parking, a collision is
+// cleared with a one-frame reset pulse so the run keeps scrolling.
+static uint8_t scenario_input(int id, int frame, const BenchOptions& opt,
+                              Vtt_um_goose_game* top, bool* reset_pending) {
+  if (id == SCENARIO_GAME_OVER) {
+    SIM_GAME_OVER(top) = 1;
+    return UI_IDLE;
+  }
+  if (*reset_pending) {
+    *reset_pending = false;
+    return make_ui_in(false, true);
+  }
+  if (SIM_GAME_OVER(top)) {
+    *reset_pending = true;
+    return UI_IDLE;
+  }
+  if (id == SCENARIO_SPEED7) SIM_SPEED_LEVEL(top) = 7;
+  if (id == SCENARIO_JUMP && frame % opt.jump_every == 0) return make_ui_in(true, false);
+  return UI_IDLE;
+}
+
+static BenchResult run_scenario(int id, const BenchOptions& opt) {
+  VerilatedContext* contextp = new VerilatedContext;
+  contextp->commandArgs(opt.argc, opt.argv);
+  Vtt_um_goose_game* top = new Vtt_um_goose_game{contextp};
+  sim_reset(top);
+
+  bool reset_pending = false;
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < opt.frames; frame++) {
+    top->ui_in = scenario_input(id, frame, opt, top, &reset_pending);
+    if (opt.legacy_tick) {
+      for (int i = 0; i < FRAME_CYCLES; i++) sim_tick_legacy(top);
+    }
+    else {
+      sim_tick(top, FRAME_CYCLES);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  unsigned threads = contextp->threads();
+
+  top->final();
+  delete top;
+  delete contextp;
+
+  BenchResult r;
+  r.name = scenario_names[id];
+  r.threads = threads;
+  r.frames = opt.frames;
+  r.cycles = (uint64_t)opt.frames * FRAME_CYCLES;
+  r.seconds = std::chrono::duration<double>(end - start).count();
+  r.cycles_per_sec = r.cycles / r.seconds;
+  r.frames_per_sec = r.frames / r.seconds;
+  r.ns_per_eval = r.seconds * 1e9 / (double)(r.cycles * 2);
+  return r;
+}
+
+static std::string results_json(const std::vector<BenchResult>& results, const BenchOptions& opt) {
+  std::string s = "{\n";
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+           "  \"threads\": %u,\n  \"frames\": %d,\n  \"jump_every\": %d,\n"
+           "  \"tick\": \"%s\",\n",
+           results.empty() ? 1u : results[0].threads, opt.frames, opt.jump_every,
+           opt.legacy_tick ? "legacy" : "batched");
+  s += buf;
+  s += "  \"scenarios\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult& r = results[i];
+    snprintf(buf, sizeof(buf),
+             "    {\"name\": \"%s\", \"frames\": %llu, \"cycles\": %llu, \"seconds\": %.6f, "
+             "\"cycles_per_sec\": %.1f, \"frames_per_sec\": %.3f, \"ns_per_eval\": %.3f}%s\n",
+             r.name, (unsigned long long)r.frames, (unsigned long long)r.cycles, r.seconds,
+             r.cycles_per_sec, r.frames_per_sec, r.ns_per_eval,
+             i + 1 < results.size() ? "," : "");
+    s += buf;
+  }
+  s += "  ]\n}\n";
+  return s;
+}
+
+static bool read_file(const char* path, std::string* out) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) return false;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out->append(buf, n);
+  fclose(f);
+  return true;
+}
+
+// Find "cycles_per_sec" of the named scenario in a previous results file.
+// Only needs to understand the JSON written by results_json().
+static bool baseline_cycles_per_sec(const std::string& json, const char* name, double* value) {
+  std::string key = std::string("\"name\": \"") + name + "\"";
+  size_t pos = json.find(key);
+  if (pos == std::string::npos) return false;
+  size_t end = json.find('}', pos);
+  pos = json.find("\"cycles_per_sec\":", pos);
+  if (pos == std::string::npos || pos > end) return false;
+  *value = strtod(json.c_str() + pos + strlen("\"cycles_per_sec\":"), nullptr);
+  return *value > 0;
+}
+
+static int check_baseline(const std::vector<BenchResult>& results, const BenchOptions& opt) {
+  std::string json;
+  if (!read_file(opt.baseline, &json)) {
+    fprintf(stderr, "bench: cannot read baseline %s\n", opt.baseline);
+    return 2;
+  }
+  int failures = 0;
+  for (const BenchResult& r : results) {
+    double base;
+    if (!baseline_cycles_per_sec(json, r.name, &base)) {
+      fprintf(stderr, "bench: %-10s no baseline entry, skipped\n", r.name);
+      continue;
+    }
+    double ratio = r.cycles_per_sec / base;
+    bool ok = ratio >= 1.0 - opt.tolerance;
+    fprintf(stderr, "bench: %-10s %.0f cycles/s vs baseline %.0f (%+.1f%%) %s\n",
+            r.name, r.cycles_per_sec, base, (ratio - 1.0) * 100.0, ok ? "ok" : "REGRESSION");
+    if (!ok) failures++;
+  }
+  return failures ? 1 : 0;
+}
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --frames N          frames per scenario (default 120)\n"
+          "  --jump-every N      jump period for the jump scenario (default 30)\n"
+          "  --scenario LIST     comma-separated subset of idle,jump,speed7,game_over\n"
+          "  --out FILE          also write the JSON results to FILE\n"
+          "  --baseline FILE     fail if slower than a previous results file\n"
+          "  --tolerance PCT     allowed slowdown against the baseline (default 10)\n"
+          "  --tick MODE         batched (sim_tick, default) or legacy eval() per edge\n",
+          prog);
+}
+
+static bool parse_scenarios(char* list, BenchOptions* opt) {
+  for (int i = 0; i < SCENARIO_COUNT; i++) opt->enabled[i] = false;
+  for (char* tok = strtok(list, ","); tok != nullptr; tok = strtok(nullptr, ",")) {
+    int id = scenario_by_name(tok);
+    if (id < 0) {
+      fprintf(stderr, "bench: unknown scenario '%s'\n", tok);
+      return false;
+    }
+    opt->enabled[id] = true;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  Verilated::commandArgs(argc, argv);
+
+  BenchOptions opt;
+  opt.argc = argc;
+  opt.argv = argv;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg[0] == '+') continue;  // +verilator+ runtime options
+    if (strcmp(arg, "--frames") == 0 && has_value) opt.frames = atoi(argv[++i]);
+    else if (strcmp(arg, "--jump-every") == 0 && has_value) opt.jump_every = atoi(argv[++i]);
+    else if (strcmp(arg, "--tolerance") == 0 && has_value) opt.tolerance = atof(argv[++i]) / 100.0;
+    else if (strcmp(arg, "--baseline") == 0 && has_value) opt.baseline = argv[++i];
+    else if (strcmp(arg, "--out") == 0 && has_value) opt.out = argv[++i];
+    else if (strcmp(arg, "--tick") == 0 && has_value) {
+      const char* mode = argv[++i];
+      if (strcmp(mode, "legacy") != 0 && strcmp(mode, "batched") != 0) {
+        usage(argv[0]);
+        return 2;
+      }
+      opt.legacy_tick = strcmp(mode, "legacy") == 0;
+    }
+    else if (strcmp(arg, "--scenario") == 0 && has_value) {
+      if (!parse_scenarios(argv[++i], &opt)) return 2;
+    }
+    else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (opt.frames <= 0 || opt.jump_every <= 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  std::vector<BenchResult> results;
+  for (int id = 0; id < SCENARIO_COUNT; id++) {
+    if (!opt.enabled[id]) continue;
+    results.push_back(run_scenario(id, opt));
+    fprintf(stderr, "bench: %-10s %.2f fps\n", results.back().name, results.back().frames_per_sec);
+  }
+
+  std::string json = results_json(results, opt);
+  fputs(json.c_str(), stdout);
+  if (opt.out != nullptr) {
+    FILE* f = fopen(opt.out, "w");
+    if (f == nullptr) {
+      fprintf(stderr, "bench: cannot write %s\n", opt.out);
+      return 2;
+    }
+    fputs(json.c_str(), f);
+    fclose(f);
+  }
+
+  if (opt.baseline != nullptr) return check_baseline(results, opt);
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * libgoosegame.so: the Verilated model behind the C API in goosegame_capi.h.
+ */
+
+#include <stdint.h>
+#include <new>
+#include "goosegame_capi.h"
+#include "goosegame_sim.h"
+#include "vga_capture.h"
+#include "game_state.h"
+
+// Give up waiting for a vsync edge after this many cycles
+#define CAPI_TIMEOUT_CYCLES (4 * FRAME_CYCLES)
+
+struct goosegame {
+  VerilatedContext* contextp;
+  Vtt_um_goose_game* top;
+  VgaCapture capture;
+  uint64_t cycle;
+};
+
+extern "C" {
+
+int goosegame_api_version(void) { return GOOSEGAME_API_VERSION; }
+
+uint64_t goosegame_frame_cycles(void) { return FRAME_CYCLES; }
+
+goosegame* goosegame_create(void) {
+  goosegame* g = new (std::nothrow) goosegame;
+  if (g == nullptr) return nullptr;
+  g->contextp = new VerilatedContext;
+  g->top = new Vtt_um_goose_game{g->contextp};
+  goosegame_reset(g);
+  return g;
+}
+
+void goosegame_destroy(goosegame* g) {
+  if (g == nullptr) return;
+  g->top->final();
+  delete g->top;
+  delete g->contextp;
+  delete g;
+}
+
+void goosegame_reset(goosegame* g) {
+  sim_reset(g->top);
+  g->capture.reset();
+  g->cycle = 0;
+}
+
+void goosegame_set_inputs(goosegame* g, int jump, int reset) {
+  g->top->ui_in = make_ui_in(jump != 0, reset != 0);
+}
+
+void goosegame_tick(goosegame* g, uint64_t n) {
+  g->cycle += n;
+  while (n > 0) {
+    uint32_t chunk = n > UINT32_MAX ? UINT32_MAX : (uint32_t)n;
+    sim_tick(g->top, chunk);
+    n -= chunk;
+  }
+}
+
+void goosegame_get_state(goosegame* g, goosegame_state* out) {
+  GameState s = game_state(g->top);
+  out->cycle = g->cycle;
+  out->frame = g->cycle / FRAME_CYCLES;
+  out->obstacle_pos = s.obstacle_pos;
+  out->scrolladdr = s.scrolladdr;
+  out->jump_pos = s.jump_pos;
+  out->speed_level = s.speed_level;
+  out->game_over = s.game_over;
+  out->reserved = 0;
+}
+
+void goosegame_frame_size(goosegame* g, int* width, int* height) {
+  *width = g->capture.width();
+  *height = g->capture.height();
+}
+
+// Clock until the capture completes a frame into the target already set
+static int run_frame(goosegame* g) {
+  for (int i = 0; i < CAPI_TIMEOUT_CYCLES; i++) {
+    sim_tick(g->top);
+    g->cycle++;
+    if (g->capture.sample(g->top->uo_out)) return GOOSEGAME_OK;
+  }
+  return GOOSEGAME_ERR_NO_SYNC;
+}
+
+static bool fits(const goosegame* g, int width, int height) {
+  return g->capture.width() <= width && g->capture.height() <= height;
+}
+
+int goosegame_run_frame(goosegame* g, uint32_t* argb, int width, int height) {
+  if (!fits(g, width, height)) return GOOSEGAME_ERR_BUFFER;
+  g->capture.set_target(argb, width);
+  return run_frame(g);
+}
+
+int goosegame_run_frame_indexed(goosegame* g, uint8_t* pixels, int width, int height) {
+  if (!fits(g, width, height)) return GOOSEGAME_ERR_BUFFER;
+  g->capture.set_target(pixels, width);
+  return run_frame(g);
+}
+
+void goosegame_palette(uint32_t* argb) {
+  for (int i = 0; i < GOOSEGAME_PALETTE_SIZE; i++) argb[i] = pmod_argb((uint8_t)i);
+}
+
+}
@@ -0,0 +1,99 @@
+/*
+ * C API of libgoosegame.so (make libgoosegame.so).
+ *
+ * Each handle owns one Verilated model with its own context, so handles
+ * can be used from different threads, one thread per handle. Frames are
+ * decoded straight into a caller-provided ARGB8888 buffer with no copy:
+ * from Python, pass numpy.empty((height, width), numpy.uint32) through
+ * ctypes and it holds the frame when goosegame_run_frame() returns.
+ * goosegame_run_frame_indexed() writes one byte per pixel instead, a
+ * quarter of the memory traffic, to be looked up in goosegame_palette().
+ *
+ * The ABI is plain C with fixed-width types. GOOSEGAME_API_VERSION goes
+ * up whenever a function or struct changes; check goosegame_api_version()
+ * before using the library.
+ */
+
+#ifndef GOOSEGAME_CAPI_H
+#define GOOSEGAME_CAPI_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define GOOSEGAME_API __attribute__((visibility("default")))
+#else
+#define GOOSEGAME_API
+#endif
+
+#define GOOSEGAME_API_VERSION 3
+
+// Entries of goosegame_palette(); indices are the RGB bits of uo_out
+#define GOOSEGAME_PALETTE_SIZE 128
+
+// goosegame_run_frame() results
+#define GOOSEGAME_OK 0
+#define GOOSEGAME_ERR_BUFFER -1   // buffer smaller than goosegame_frame_size()
+#define GOOSEGAME_ERR_NO_SYNC -2  // no vsync edge within 4 frames of cycles
+
+typedef struct goosegame goosegame;
+
+// Game state registers plus the cycle count. 24 bytes, no padding, laid
+// out like the binary telemetry record with the frame widened.
+typedef struct goosegame_state {
+  uint64_t cycle;  // design cycles since reset
+  uint64_t frame;  // cycle / goosegame_frame_cycles()
+  uint16_t obstacle_pos;
+  uint16_t scrolladdr;
+  uint8_t jump_pos;
+  uint8_t speed_level;
+  uint8_t game_over;
+  uint8_t reserved;
+} goosegame_state;
+
+GOOSEGAME_API int goosegame_api_version(void);
+
+// Cycles per frame of this build: H_TOTAL * V_TOTAL, 420000 for standard
+// VGA timing and fewer with REDUCED_BLANKING
+GOOSEGAME_API uint64_t goosegame_frame_cycles(void);
+
+// New model, already reset with no buttons pressed. NULL on failure.
+GOOSEGAME_API goosegame* goosegame_create(void);
+GOOSEGAME_API void goosegame_destroy(goosegame* g);
+
+// Pulse rst_n and release the buttons; the cycle count restarts at 0
+GOOSEGAME_API void goosegame_reset(goosegame* g);
+
+// Buttons held from the next cycle on (non-zero = pressed)
+GOOSEGAME_API void goosegame_set_inputs(goosegame* g, int jump, int reset);
+
+// Clock n cycles with no pixel decoding
+GOOSEGAME_API void goosegame_tick(goosegame* g, uint64_t n);
+
+GOOSEGAME_API void goosegame_get_state(goosegame* g, goosegame_state* out);
+
+// Visible window of the next decoded frame, measured from the syncs
+// (640x480 for standard VGA timing)
+GOOSEGAME_API void goosegame_frame_size(goosegame* g, int* width, int* height);
+
+// Clock to the next vsync edge, decoding the visible pixels into argb, a
+// row-major width x height buffer at least as large as the frame. Nothing
+// is clocked when it is too small. The first frame after reset or create
+// is partial while the capture locks onto the syncs.
+GOOSEGAME_API int goosegame_run_frame(goosegame* g, uint32_t* argb, int width, int height);
+
+// Same, writing palette indices
+GOOSEGAME_API int goosegame_run_frame_indexed(goosegame* g, uint8_t* pixels, int width,
+                                              int height);
+
+// ARGB8888 color of every index into argb[GOOSEGAME_PALETTE_SIZE]
+GOOSEGAME_API void goosegame_palette(uint32_t* argb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
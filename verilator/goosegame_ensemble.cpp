@@ -0,0 +1,237 @@
+/*
+ * Parallel ensemble runner for jump-timing sweeps.
+ *
+ * Each job presses jump once, at frame F plus cycle C after reset, and
+ * runs its own model instance (own VerilatedContext) headlessly until the
+ * goose collides or --frames have passed. Jobs are spread over a
+ * work-stealing pool (work_pool.h) and collected into one JSON report
+ * with whether each run survived, its collision frame and final
+ * speed_level. No pixels are decoded; only game state is read.
+ *
+ * With --model the jobs run the C++ game model (game_model.h) instead of
+ * the Verilated RTL. It skips between events rather than clocking every
+ * cycle, so wide sweeps take a fraction of the time; check it against the
+ * RTL with goosegame-replay --lockstep.
+ *
+ * With --restore every job starts from the same checkpoint (checkpoint.h),
+ * loaded once and restored from memory, instead of from reset. Jump and
+ * collision frames then count from the checkpoint.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "goosegame_sim.h"
+#include "checkpoint.h"
+#include "game_model.h"
+#include "work_pool.h"
+
+struct SweepRange {
+  long first = 0;
+  long last = 0;
+  long step = 1;
+};
+
+struct EnsembleOptions {
+  int frames = 300;
+  uint32_t hold = H_TOTAL;  // cycles the jump button stays pressed
+  unsigned threads = 0;     // 0 = one per hardware thread
+  SweepRange jump_frames;
+  SweepRange jump_cycles;
+  const char* out = nullptr;
+  bool model = false;       // game_model.h instead of the RTL
+  const char* restore = nullptr;
+  Checkpoint checkpoint;    // loaded from restore
+};
+
+struct EnsembleJob {
+  long jump_frame;
+  long jump_cycle;
+  // Results
+  bool survived;
+  int collision_frame;
+  int speed_level;
+};
+
+// Press jump once, run until game over or opt.frames. advance(n, ui_in)
+// clocks the backend n cycles with ui_in applied.
+template <typename Advance, typename GameOver>
+static void run_schedule(EnsembleJob* job, const EnsembleOptions& opt, Advance advance,
+                         GameOver game_over) {
+  uint64_t press = (uint64_t)job->jump_frame * FRAME_CYCLES + job->jump_cycle;
+  uint64_t release = press + opt.hold;
+  uint64_t cycle = 0;
+  uint8_t ui_in = UI_IDLE;
+
+  job->survived = true;
+  job->collision_frame = -1;
+  for (int frame = 0; frame < opt.frames; frame++) {
+    uint64_t frame_end = (uint64_t)(frame + 1) * FRAME_CYCLES;
+    // Split the frame at the press and release cycles
+    const uint64_t edges[2] = {press, release};
+    for (uint64_t edge : edges) {
+      if (edge > cycle && edge < frame_end) {
+        advance(edge - cycle, ui_in);
+        cycle = edge;
+      }
+      if (cycle == press) ui_in = make_ui_in(true, false);
+      if (cycle == release) ui_in = UI_IDLE;
+    }
+    advance(frame_end - cycle, ui_in);
+    cycle = frame_end;
+
+    if (game_over()) {
+      job->survived = false;
+      job->collision_frame = frame;
+      break;
+    }
+  }
+}
+
+static void run_job(EnsembleJob* job, const EnsembleOptions& opt) {
+  if (opt.model) {
+    GameModel model;
+    run_schedule(job, opt, [&](uint64_t n, uint8_t ui_in) { model.advance(n, ui_in); },
+                 [&] { return model.game_over(); });
+    job->speed_level = model.speed_level();
+    return;
+  }
+
+  VerilatedContext* contextp = new VerilatedContext;
+  Vtt_um_goose_game* top = new Vtt_um_goose_game{contextp};
+  if (opt.restore == nullptr) sim_reset(top);
+  else checkpoint_restore(contextp, top, opt.checkpoint);
+  run_schedule(job, opt,
+               [&](uint64_t n, uint8_t ui_in) {
+                 top->ui_in = ui_in;
+                 sim_tick(top, (uint32_t)n);
+               },
+               [&] { return SIM_GAME_OVER(top) != 0; });
+  job->speed_level = SIM_SPEED_LEVEL(top);
+
+  top->final();
+  delete top;
+  delete contextp;
+}
+
+// "A", "A:B" or "A:B:STEP"
+static bool parse_range(const char* text, SweepRange* r) {
+  char* end;
+  r->first = strtol(text, &end, 10);
+  r->last = r->first;
+  r->step = 1;
+  if (*end == ':') r->last = strtol(end + 1, &end, 10);
+  if (*end == ':') r->step = strtol(end + 1, &end, 10);
+  return *end == '\0' && r->first >= 0 && r->last >= r->first && r->step > 0;
+}
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --jump-frames A:B[:S]  frames to press jump at (default 0)\n"
+          "  --jump-cycles A:B[:S]  cycle offsets within that frame (default 0)\n"
+          "  --frames N             frames to run each job for (default 300)\n"
+          "  --hold N               cycles jump stays pressed (default %d)\n"
+          "  --threads N            worker threads (default: all cores)\n"
+          "  --model                run the C++ game model instead of the RTL\n"
+          "  --restore FILE         start every job from a checkpoint\n"
+          "  --out FILE             also write the JSON report to FILE\n",
+          prog, H_TOTAL);
+}
+
+int main(int argc, char** argv) {
+  Verilated::commandArgs(argc, argv);
+
+  EnsembleOptions opt;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool has_value = i + 1 < argc;
+    bool ok = true;
+    if (arg[0] == '+') continue;  // +verilator+ runtime options
+    if (strcmp(arg, "--jump-frames") == 0 && has_value) ok = parse_range(argv[++i], &opt.jump_frames);
+    else if (strcmp(arg, "--jump-cycles") == 0 && has_value) ok = parse_range(argv[++i], &opt.jump_cycles);
+    else if (strcmp(arg, "--frames") == 0 && has_value) opt.frames = atoi(argv[++i]);
+    else if (strcmp(arg, "--hold") == 0 && has_value) opt.hold = (uint32_t)atol(argv[++i]);
+    else if (strcmp(arg, "--threads") == 0 && has_value) opt.threads = (unsigned)atoi(argv[++i]);
+    else if (strcmp(arg, "--out") == 0 && has_value) opt.out = argv[++i];
+    else if (strcmp(arg, "--model") == 0) opt.model = true;
+    else if (strcmp(arg, "--restore") == 0 && has_value) opt.restore = argv[++i];
+    else ok = false;
+    if (!ok) {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (opt.frames <= 0 || opt.jump_cycles.last >= FRAME_CYCLES ||
+      (opt.model && opt.restore != nullptr)) {
+    usage(argv[0]);
+    return 2;
+  }
+  if (opt.restore != nullptr) {
+    // Fail here rather than in every job
+    VerilatedContext context;
+    Vtt_um_goose_game check{&context};
+    if (!checkpoint_read(opt.restore, &opt.checkpoint) ||
+        !checkpoint_restore(&context, &check, opt.checkpoint)) {
+      fprintf(stderr, "ensemble: cannot restore checkpoint %s\n", opt.restore);
+      return 2;
+    }
+    check.final();
+  }
+  if (opt.threads == 0) opt.threads = std::thread::hardware_concurrency();
+
+  std::vector<EnsembleJob> jobs;
+  for (long f = opt.jump_frames.first; f <= opt.jump_frames.last; f += opt.jump_frames.step) {
+    for (long c = opt.jump_cycles.first; c <= opt.jump_cycles.last; c += opt.jump_cycles.step) {
+      EnsembleJob job = {f, c, false, -1, 0};
+      jobs.push_back(job);
+    }
+  }
+
+  WorkStealingPool pool(opt.threads);
+  for (EnsembleJob& job : jobs) {
+    EnsembleJob* j = &job;
+    pool.submit([j, &opt] { run_job(j, opt); });
+  }
+  auto start = std::chrono::steady_clock::now();
+  pool.run();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  size_t survived = 0;
+  for (const EnsembleJob& job : jobs) survived += job.survived;
+
+  std::string s;
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "{\n  \"jobs\": %zu,\n  \"survived\": %zu,\n  \"frames\": %d,\n  \"threads\": %u,\n"
+           "  \"backend\": \"%s\",\n  \"seconds\": %.3f,\n  \"results\": [\n",
+           jobs.size(), survived, opt.frames, pool.workers(), opt.model ? "model" : "rtl", seconds);
+  s += buf;
+  for (size_t i = 0; i < jobs.size(); i++) {
+    const EnsembleJob& job = jobs[i];
+    snprintf(buf, sizeof(buf),
+             "    {\"jump_frame\": %ld, \"jump_cycle\": %ld, \"survived\": %s, "
+             "\"collision_frame\": %d, \"speed_level\": %d}%s\n",
+             job.jump_frame, job.jump_cycle, job.survived ? "true" : "false",
+             job.collision_frame, job.speed_level, i + 1 < jobs.size() ? "," : "");
+    s += buf;
+  }
+  s += "  ]\n}\n";
+
+  fputs(s.c_str(), stdout);
+  if (opt.out != nullptr) {
+    FILE* f = fopen(opt.out, "w");
+    if (f == nullptr) {
+      fprintf(stderr, "ensemble: cannot write %s\n", opt.out);
+      return 2;
+    }
+    fputs(s.c_str(), f);
+    fclose(f);
+  }
+  return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * Throughput driver for the step/observe environment (goose_env.h).
+ *
+ * Each worker thread owns one GooseEnvBatch and steps it with a fixed
+ * policy: random jumps, or a scripted jump when the obstacle reaches the
+ * goose. Prints env steps and frames per second and the mean episode
+ * length as JSON. Doubles as an example of driving the API.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "goose_env.h"
+
+// Jumping while obstacle_pos is in this range clears the obstacle up to
+// speed_level 5 (checked on game_model.h)
+#define SCRIPTED_JUMP_FIRST 576
+#define SCRIPTED_JUMP_LAST 588
+
+enum Policy { POLICY_RANDOM, POLICY_SCRIPTED };
+
+struct DriverOptions {
+  unsigned threads = 1;
+  size_t envs = 16;         // per thread
+  int steps = 200;          // batch steps per thread
+  int frames_per_step = 1;
+  Policy policy = POLICY_SCRIPTED;
+  EnvOptions env;
+};
+
+struct WorkerResult {
+  uint64_t steps = 0;
+  uint64_t frames = 0;
+  uint64_t episodes = 0;      // finished by game over
+  uint64_t episode_frames = 0;
+};
+
+static uint8_t choose(Policy policy, const EnvStep& s, std::mt19937& rng) {
+  if (policy == POLICY_RANDOM) return rng() % 8 == 0 ? ENV_JUMP : ENV_NOOP;
+  bool near = s.state.obstacle_pos >= SCRIPTED_JUMP_FIRST && s.state.obstacle_pos <= SCRIPTED_JUMP_LAST;
+  return near ? ENV_JUMP : ENV_NOOP;
+}
+
+static void run_worker(unsigned index, const DriverOptions& opt, WorkerResult* result) {
+  EnvOptions env_opt = opt.env;
+  env_opt.seed = opt.env.seed + index * opt.envs;
+  GooseEnvBatch batch(opt.envs, env_opt);
+  std::vector<EnvStep> steps(batch.size());
+  std::vector<uint8_t> actions(batch.size());
+  std::mt19937 rng((uint32_t)env_opt.seed);
+
+  batch.reset(steps.data());
+  for (int n = 0; n < opt.steps; n++) {
+    for (size_t i = 0; i < batch.size(); i++) actions[i] = choose(opt.policy, steps[i], rng);
+    batch.step(actions.data(), opt.frames_per_step, steps.data());
+    for (const EnvStep& s : steps) {
+      result->steps++;
+      result->frames += s.frames;
+      if (s.done) {
+        result->episodes++;
+        result->episode_frames += s.frame;
+      }
+    }
+  }
+}
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --threads N          worker threads, one batch each (default 1)\n"
+          "  --envs B             environments per batch (default 16)\n"
+          "  --steps N            batch steps per thread (default 200)\n"
+          "  --frames-per-step K  frames each action is held for (default 1)\n"
+          "  --policy P           scripted (default) or random\n"
+          "  --pixels             also observe downsampled frames\n"
+          "  --downsample F       frame downsampling factor (default 8)\n"
+          "  --randomize          random obstacle phase at every reset\n"
+          "  --seed S             first env seed (default 1)\n"
+          "  --restore FILE       start every episode from a checkpoint\n",
+          prog);
+}
+
+int main(int argc, char** argv) {
+  Verilated::commandArgs(argc, argv);
+
+  DriverOptions opt;
+  Checkpoint checkpoint;
+  const char* restore = nullptr;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool has_value = i + 1 < argc;
+    bool ok = true;
+    if (arg[0] == '+') continue;  // +verilator+ runtime options
+    if (strcmp(arg, "--threads") == 0 && has_value) opt.threads = (unsigned)atoi(argv[++i]);
+    else if (strcmp(arg, "--envs") == 0 && has_value) opt.envs = (size_t)atoi(argv[++i]);
+    else if (strcmp(arg, "--steps") == 0 && has_value) opt.steps = atoi(argv[++i]);
+    else if (strcmp(arg, "--frames-per-step") == 0 && has_value) opt.frames_per_step = atoi(argv[++i]);
+    else if (strcmp(arg, "--policy") == 0 && has_value) {
+      const char* name = argv[++i];
+      if (strcmp(name, "random") == 0) opt.policy = POLICY_RANDOM;
+      else if (strcmp(name, "scripted") == 0) opt.policy = POLICY_SCRIPTED;
+      else ok = false;
+    }
+    else if (strcmp(arg, "--pixels") == 0) opt.env.observe_pixels = true;
+    else if (strcmp(arg, "--downsample") == 0 && has_value) opt.env.downsample = atoi(argv[++i]);
+    else if (strcmp(arg, "--randomize") == 0) opt.env.randomize_phase = true;
+    else if (strcmp(arg, "--seed") == 0 && has_value) opt.env.seed = strtoull(argv[++i], nullptr, 10);
+    else if (strcmp(arg, "--restore") == 0 && has_value) restore = argv[++i];
+    else ok = false;
+    if (!ok) {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (opt.threads == 0 || opt.envs == 0 || opt.steps <= 0 || opt.frames_per_step <= 0 ||
+      opt.env.downsample <= 0) {
+    usage(argv[0]);
+    return 2;
+  }
+  if (restore != nullptr) {
+    if (!checkpoint_read(restore, &checkpoint)) {
+      fprintf(stderr, "env: cannot read checkpoint %s\n", restore);
+      return 2;
+    }
+    opt.env.start = &checkpoint;
+  }
+
+  std::vector<WorkerResult> results(opt.threads);
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < opt.threads; t++) workers.emplace_back(run_worker, t, std::cref(opt), &results[t]);
+  for (std::thread& w : workers) w.join();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  WorkerResult total;
+  for (const WorkerResult& r : results) {
+    total.steps += r.steps;
+    total.frames += r.frames;
+    total.episodes += r.episodes;
+    total.episode_frames += r.episode_frames;
+  }
+  printf("{\"threads\": %u, \"envs\": %zu, \"steps\": %llu, \"frames\": %llu, \"pixels\": %s, "
+         "\"seconds\": %.3f, \"steps_per_sec\": %.1f, \"frames_per_sec\": %.1f, "
+         "\"episodes\": %llu, \"mean_episode_frames\": %.1f}\n",
+         opt.threads, opt.threads * opt.envs, (unsigned long long)total.steps,
+         (unsigned long long)total.frames, opt.env.observe_pixels ? "true" : "false", seconds,
+         total.steps / seconds, total.frames / seconds, (unsigned long long)total.episodes,
+         total.episodes ? (double)total.episode_frames / total.episodes : 0.0);
+  return 0;
+}
@@ -0,0 +1,364 @@
+/*
+ * Headless replay of a recorded input log.
+ *
+ * Feeds the ui_in changes recorded by `goosegame --record` back into a
+ * freshly reset model at the exact cycles they were applied, with no SDL
+ * and no pacing, then prints how fast it ran and the final game state.
+ *
+ * With --hash-out or --golden every frame is captured and reduced to a
+ * hash line (frame_hash.h). Against a golden stream the run stops at the
+ * first differing frame and writes only that frame as an image.
+ *
+ * With --video every Nth frame is decoded straight into a buffer of the
+ * video writer (video_writer.h) and written out as Y4M or raw RGB on its
+ * own thread.
+ *
+ * With --telemetry the game state registers are logged at the end of every
+ * frame (game_state.h), straight from the model with no pixel decode.
+ *
+ * With --lockstep the C++ game model (game_model.h) runs alongside and its
+ * state is compared with the RTL at the end of every frame. The run stops
+ * at the first divergence and prints both states.
+ *
+ * --checkpoint FILE stops the replay at the end of --checkpoint-at FRAME
+ * (or of the log) and saves the model state there (checkpoint.h).
+ * --restore FILE continues a log from such a checkpoint instead of from
+ * reset. The capture relocks after a restore, so its frames cannot be
+ * compared with a hash stream recorded from reset.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "goosegame_sim.h"
+#include "vga_capture.h"
+#include "input_log.h"
+#include "frame_hash.h"
+#include "trace_window.h"
+#include "video_writer.h"
+#include "checkpoint.h"
+
+struct ReplayOptions {
+  const char* log = nullptr;
+  const char* hash_out = nullptr;
+  const char* golden = nullptr;
+  const char* diff_image = "mismatch.ppm";
+  const char* trace = nullptr;
+  const char* video = nullptr;
+  VideoFormat video_format = VIDEO_Y4M;
+  int video_every = 1;
+  const char* telemetry = nullptr;
+  TelemetryFormat telemetry_format = TELEMETRY_CSV;
+  bool lockstep = false;
+  const char* checkpoint = nullptr;
+  uint64_t checkpoint_at = UINT64_MAX;  // frame, default the end of the log
+  const char* restore = nullptr;
+  TraceTrigger trace_start;
+  TraceTrigger trace_stop;
+};
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "Usage: %s [options] <input.log>\n"
+          "  --hash-out FILE     write one hash line per frame\n"
+          "  --golden FILE       compare against a golden hash stream\n"
+          "  --diff-image FILE   first mismatching frame (default mismatch.ppm)\n"
+          "  --video FILE        write frames as video, - for stdout\n"
+          "  --video-format FMT  y4m (default) or rgb (raw BGRA)\n"
+          "  --video-every N     write every Nth frame (default 1), y4m rate divided by N\n"
+          "  --telemetry FILE    log game state at the end of every frame\n"
+          "  --telemetry-format FMT  csv (default) or bin\n"
+          "  --lockstep          check the C++ game model against the RTL every frame\n"
+          "  --checkpoint FILE   save the model state at the end of the replay\n"
+          "  --checkpoint-at N   end the replay after frame N, for --checkpoint\n"
+          "  --restore FILE      continue from a checkpoint instead of reset\n"
+          "  --trace FILE        write an FST trace between the start and stop triggers\n"
+          "  --trace-start TRIG  frame:N, cycle:N or game_over (default: from reset)\n"
+          "  --trace-stop TRIG   frame:N, cycle:N or game_over (default: never)\n",
+          prog);
+}
+
+static bool parse_args(int argc, char** argv, ReplayOptions* opt) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg[0] == '+') continue;  // +verilator+ runtime options
+    if (strcmp(arg, "--hash-out") == 0 && has_value) opt->hash_out = argv[++i];
+    else if (strcmp(arg, "--golden") == 0 && has_value) opt->golden = argv[++i];
+    else if (strcmp(arg, "--diff-image") == 0 && has_value) opt->diff_image = argv[++i];
+    else if (strcmp(arg, "--video") == 0 && has_value) opt->video = argv[++i];
+    else if (strcmp(arg, "--video-every") == 0 && has_value) opt->video_every = atoi(argv[++i]);
+    else if (strcmp(arg, "--video-format") == 0 && has_value) {
+      if (!video_parse_format(argv[++i], &opt->video_format)) return false;
+    }
+    else if (strcmp(arg, "--telemetry") == 0 && has_value) opt->telemetry = argv[++i];
+    else if (strcmp(arg, "--telemetry-format") == 0 && has_value) {
+      if (!telemetry_parse_format(argv[++i], &opt->telemetry_format)) return false;
+    }
+    else if (strcmp(arg, "--lockstep") == 0) opt->lockstep = true;
+    else if (strcmp(arg, "--checkpoint") == 0 && has_value) opt->checkpoint = argv[++i];
+    else if (strcmp(arg, "--checkpoint-at") == 0 && has_value) {
+      opt->checkpoint_at = strtoull(argv[++i], nullptr, 10);
+    }
+    else if (strcmp(arg, "--restore") == 0 && has_value) opt->restore = argv[++i];
+    else if (strcmp(arg, "--trace") == 0 && has_value) opt->trace = argv[++i];
+    else if (strcmp(arg, "--trace-start") == 0 && has_value) {
+      if (!trace_parse_trigger(argv[++i], &opt->trace_start)) return false;
+    }
+    else if (strcmp(arg, "--trace-stop") == 0 && has_value) {
+      if (!trace_parse_trigger(argv[++i], &opt->trace_stop)) return false;
+    }
+    else if (arg[0] != '-' && opt->log == nullptr) opt->log = arg;
+    else return false;
+  }
+  // The game model always starts from reset, and hash streams count
+  // captured frames from it
+  if (opt->restore != nullptr &&
+      (opt->lockstep || opt->golden != nullptr || opt->hash_out != nullptr)) {
+    return false;
+  }
+  return opt->log != nullptr && opt->video_every > 0;
+}
+
+static void describe_mismatch(const FrameRecord& got, const FrameRecord& want) {
+  fprintf(stderr, "replay: frame %llu differs from golden:", (unsigned long long)got.frame);
+  if (got.pixels != want.pixels) {
+    fprintf(stderr, " pixels %016llx != %016llx", (unsigned long long)got.pixels,
+            (unsigned long long)want.pixels);
+  }
+  if (got.game_over != want.game_over) {
+    fprintf(stderr, " game_over %d != %d", got.game_over, want.game_over);
+  }
+  if (got.speed_level != want.speed_level) {
+    fprintf(stderr, " speed_level %d != %d", got.speed_level, want.speed_level);
+  }
+  if (got.obstacle_pos != want.obstacle_pos) {
+    fprintf(stderr, " obstacle_pos %d != %d", got.obstacle_pos, want.obstacle_pos);
+  }
+  if (got.jump_pos != want.jump_pos) {
+    fprintf(stderr, " jump_pos %d != %d", got.jump_pos, want.jump_pos);
+  }
+  if (got.scrolladdr != want.scrolladdr) {
+    fprintf(stderr, " scrolladdr %d != %d", got.scrolladdr, want.scrolladdr);
+  }
+  fprintf(stderr, "\n");
+}
+
+// Replay one cycle at a time, capturing and hashing every frame, exporting
+// video and tracing inside the --trace window. Returns 0 when the run
+// matches the golden stream (or there is none) and the lockstep model,
+// 1 otherwise.
+static int replay_hashed(Vtt_um_goose_game* top, const InputLog& log, const ReplayOptions& opt,
+                         FILE* hash_out, FILE* golden, TraceWindow* trace, VideoWriter* video,
+                         TelemetryLog* telemetry, Lockstep* lockstep, uint64_t start_cycle) {
+  InputPlayer player(log);
+  VgaCapture capture;
+  std::vector<uint8_t> scratch;
+  VideoFrame* video_frame = nullptr;
+  uint8_t* pixels = nullptr;
+  int width = 0;
+  int height = 0;
+  uint64_t frame = 0;
+
+  // Exported frames decode straight into a writer buffer, the rest into
+  // the scratch buffer. The window only changes between frames.
+  auto set_target = [&]() {
+    width = capture.width();
+    height = capture.height();
+    video_frame = nullptr;
+    if (video->is_open() && frame % opt.video_every == 0) video_frame = video->next(width, height);
+    if (video_frame != nullptr) {
+      pixels = video_frame->pixels.data();
+    }
+    else {
+      scratch.resize((size_t)width * height);
+      pixels = scratch.data();
+    }
+    capture.set_target(pixels, width);
+  };
+
+  set_target();
+  uint64_t next_event = start_cycle;
+  for (uint64_t cycle = start_cycle; cycle < log.end_cycle; cycle++) {
+    if (cycle == next_event) next_event = player.apply(top, cycle);
+    if (trace->armed()) trace->step(top, frame, cycle);
+    else sim_tick(top);
+    if (lockstep != nullptr) lockstep->advance(1, top->ui_in);
+    if ((cycle + 1) % FRAME_CYCLES == 0) {
+      if (telemetry->is_open()) telemetry->write(cycle / FRAME_CYCLES, cycle + 1, game_state(top));
+      if (lockstep != nullptr && !lockstep->check(top, cycle / FRAME_CYCLES)) return 1;
+    }
+    if (!capture.sample(top->uo_out)) continue;
+
+    FrameRecord got = frame_record(top, frame, pixels, (size_t)width * height);
+    if (hash_out != nullptr) frame_record_write(hash_out, got);
+    if (golden != nullptr) {
+      FrameRecord want;
+      if (!frame_record_read(golden, &want)) {
+        fprintf(stderr, "replay: golden stream ends before frame %llu\n",
+                (unsigned long long)frame);
+        return 1;
+      }
+      if (got != want) {
+        describe_mismatch(got, want);
+        if (write_ppm(opt.diff_image, pixels, width, height)) {
+          fprintf(stderr, "replay: wrote frame %llu to %s\n", (unsigned long long)frame,
+                  opt.diff_image);
+        }
+        return 1;
+      }
+    }
+
+    if (video_frame != nullptr) video->submit(video_frame);
+    frame++;
+    set_target();
+  }
+
+  FrameRecord extra;
+  if (golden != nullptr && frame_record_read(golden, &extra)) {
+    fprintf(stderr, "replay: golden stream has more than %llu frames\n",
+            (unsigned long long)frame);
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  Verilated::commandArgs(argc, argv);
+
+  ReplayOptions opt;
+  if (!parse_args(argc, argv, &opt)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  InputLog log;
+  if (!input_log_load(opt.log, &log)) {
+    fprintf(stderr, "replay: cannot read input log %s\n", opt.log);
+    return 2;
+  }
+  if (opt.checkpoint_at != UINT64_MAX && (opt.checkpoint_at + 1) * FRAME_CYCLES < log.end_cycle) {
+    log.end_frame = opt.checkpoint_at + 1;
+    log.end_cycle = log.end_frame * FRAME_CYCLES;
+  }
+
+  Checkpoint restore;
+  if (opt.restore != nullptr) {
+    if (!checkpoint_read(opt.restore, &restore)) {
+      fprintf(stderr, "replay: cannot read checkpoint %s\n", opt.restore);
+      return 2;
+    }
+    if (restore.cycle > log.end_cycle) {
+      fprintf(stderr, "replay: checkpoint at cycle %llu is past the end of the log\n",
+              (unsigned long long)restore.cycle);
+      return 2;
+    }
+  }
+
+  FILE* hash_out = nullptr;
+  FILE* golden = nullptr;
+  if (opt.hash_out != nullptr) {
+    hash_out = fopen(opt.hash_out, "w");
+    if (hash_out == nullptr) {
+      fprintf(stderr, "replay: cannot write %s\n", opt.hash_out);
+      return 2;
+    }
+    fprintf(hash_out, "%s\n", FRAME_HASH_HEADER);
+  }
+  if (opt.golden != nullptr) {
+    golden = fopen(opt.golden, "r");
+    if (golden == nullptr) {
+      fprintf(stderr, "replay: cannot read golden stream %s\n", opt.golden);
+      return 2;
+    }
+    if (!frame_hash_header_ok(golden)) {
+      fprintf(stderr, "replay: %s is not a \"%s\" stream, regenerate it with make golden\n",
+              opt.golden, FRAME_HASH_HEADER);
+      return 2;
+    }
+  }
+
+  VerilatedContext* contextp = new VerilatedContext;
+  contextp->commandArgs(argc, argv);
+  VideoWriter video;
+  if (opt.video != nullptr && !video.open(opt.video, opt.video_format, opt.video_every)) {
+    fprintf(stderr, "replay: cannot write %s\n", opt.video);
+    return 2;
+  }
+
+  TelemetryLog telemetry;
+  if (opt.telemetry != nullptr && !telemetry.open(opt.telemetry, opt.telemetry_format)) {
+    fprintf(stderr, "replay: cannot write %s\n", opt.telemetry);
+    return 2;
+  }
+
+  TraceWindow trace;
+  if (opt.trace != nullptr && !trace.configure(contextp, opt.trace, opt.trace_start, opt.trace_stop)) {
+    return 2;
+  }
+  Vtt_um_goose_game* top = new Vtt_um_goose_game{contextp};
+  trace.attach(top);
+  if (opt.restore == nullptr) sim_reset(top);
+  else if (!checkpoint_restore(contextp, top, restore)) return 2;
+  uint64_t start_cycle = restore.cycle;
+
+  Lockstep lockstep;
+  Lockstep* lockstepp = opt.lockstep ? &lockstep : nullptr;
+  int status = 0;
+  auto start = std::chrono::steady_clock::now();
+  if (hash_out != nullptr || golden != nullptr || opt.trace != nullptr || opt.video != nullptr) {
+    status = replay_hashed(top, log, opt, hash_out, golden, &trace, &video, &telemetry,
+                           lockstepp, start_cycle);
+  }
+  else if (!input_log_replay(top, log, telemetry.is_open() ? &telemetry : nullptr, lockstepp,
+                             start_cycle)) {
+    status = 1;
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  uint64_t cycles = log.end_cycle - start_cycle;
+
+  if (status == 0 && opt.checkpoint != nullptr) {
+    Checkpoint ckpt;
+    if (!checkpoint_save(contextp, top, log.end_cycle, &ckpt) ||
+        !checkpoint_write(opt.checkpoint, ckpt)) {
+      fprintf(stderr, "replay: cannot write checkpoint %s\n", opt.checkpoint);
+      status = 2;
+    }
+    else {
+      fprintf(stderr, "replay: checkpoint of cycle %llu (frame %llu) written to %s\n",
+              (unsigned long long)log.end_cycle, (unsigned long long)log.end_frame,
+              opt.checkpoint);
+    }
+  }
+
+  video.close();
+  if (status == 0 && opt.lockstep) {
+    fprintf(stderr, "lockstep: model matched the RTL for %llu frames (%llu of %llu cycles "
+            "evaluated)\n", (unsigned long long)(log.end_cycle / FRAME_CYCLES),
+            (unsigned long long)lockstep.model().exact_ticks(),
+            (unsigned long long)log.end_cycle);
+  }
+  // Keep stdout clean when the video goes there
+  FILE* summary = opt.video != nullptr && strcmp(opt.video, "-") == 0 ? stderr : stdout;
+  if (status == 0) {
+    fprintf(summary, "{\"events\": %zu, \"frames\": %llu, \"cycles\": %llu, \"seconds\": %.6f, "
+           "\"cycles_per_sec\": %.1f, \"realtime_ratio\": %.3f, "
+           "\"game_over\": %d, \"speed_level\": %d}\n",
+           log.events.size(), (unsigned long long)log.end_frame,
+           (unsigned long long)cycles, seconds, cycles / seconds,
+           cycles / seconds / PIXEL_CLOCK_HZ,
+           (int)SIM_GAME_OVER(top), (int)SIM_SPEED_LEVEL(top));
+  }
+
+  if (hash_out != nullptr) fclose(hash_out);
+  if (golden != nullptr) fclose(golden);
+  trace.close();
+  top->final();
+  delete top;
+  delete contextp;
+  return status;
+}
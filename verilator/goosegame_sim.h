@@ -0,0 +1,85 @@
+/*
+ * Shared helpers for driving the Verilated goose game model.
+ * Used by the SDL testbench and the headless tools.
+ */
+
+#ifndef GOOSEGAME_SIM_H
+#define GOOSEGAME_SIM_H
+
+#include <stdint.h>
+#include "Vtt_um_goose_game.h"
+#include "Vtt_um_goose_game__Syms.h"
+#include "verilated.h"
+
+// tt_um_goose_game REDUCED_BLANKING of this build, passed in by the Makefile
+#ifndef SIM_REDUCED_BLANKING
+#define SIM_REDUCED_BLANKING 0
+#endif
+
+// Standard VGA 640x480 timing, or one-cycle porches and syncs
+#if SIM_REDUCED_BLANKING
+#define H_TOTAL 643
+#define V_TOTAL 483
+#else
+#define H_TOTAL 800
+#define V_TOTAL 525
+#endif
+#define H_DISPLAY 640
+#define V_DISPLAY 480
+#define FRAME_CYCLES (H_TOTAL * V_TOTAL)
+// VGA pixel clock, the design's real-time clock rate
+#define PIXEL_CLOCK_HZ 25175000.0
+
+// tt_um_goose_game TIME_SCALE of this build, passed in by the Makefile
+#ifndef SIM_TIME_SCALE
+#define SIM_TIME_SCALE 1
+#endif
+
+// ui_in button bits (active-low: 0 = pressed, 1 = not pressed)
+#define UI_JUMP_BIT 0x01
+#define UI_RESET_BIT 0x02
+#define UI_IDLE 0xFF
+
+// Game state registers marked public_flat_rw in game_controller.v, the only
+// signals the harnesses deposit into
+#define SIM_GAME_OVER(top) ((top)->rootp->tt_um_goose_game__DOT__game_ctrl__DOT__game_over)
+#define SIM_SPEED_LEVEL(top) ((top)->rootp->tt_um_goose_game__DOT__game_ctrl__DOT__speed_level)
+#define SIM_OBSTACLE_POS(top) ((top)->rootp->tt_um_goose_game__DOT__game_ctrl__DOT__obstacle_pos)
+// Read-only public signals, see game_state.h for typed access
+#define SIM_JUMP_POS(top) ((top)->rootp->tt_um_goose_game__DOT__jumping_inst__DOT__jump_pos)
+#define SIM_SCROLLADDR(top) ((top)->rootp->tt_um_goose_game__DOT__scrolladdr)
+
+static inline uint8_t make_ui_in(bool jump, bool reset) {
+  return 0xFC | (reset ? 0 : UI_RESET_BIT) | (jump ? 0 : UI_JUMP_BIT);
+}
+
+// Advance the design by one clock cycle with two full eval() calls
+static inline void sim_tick_legacy(Vtt_um_goose_game* top) {
+  top->clk = 0; top->eval();
+  top->clk = 1; top->eval();
+}
+
+// Advance the design by n clock cycles in one call: eval_step() for each
+// edge and a single eval_end_step() for the batch
+static inline void sim_tick(Vtt_um_goose_game* top, uint32_t n = 1) {
+  for (uint32_t i = 0; i < n; i++) {
+    top->clk = 0; top->eval_step();
+    top->clk = 1; top->eval_step();
+  }
+  top->eval_end_step();
+}
+
+// Set default inputs and pulse the active-low reset
+static inline void sim_reset(Vtt_um_goose_game* top) {
+  top->ui_in = UI_IDLE;
+  top->uio_in = 0;
+  top->ena = 1;
+
+  top->rst_n = 0;
+  top->clk = 0; top->eval();
+  top->clk = 1; top->eval();
+  top->rst_n = 1;
+  top->clk = 0; top->eval();
+}
+
+#endif
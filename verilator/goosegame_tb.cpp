@@ -1,48 +1,386 @@
 #include <stdint.h>
-#include "Vtt_um_goose_game.h"
-#include "Vtt_um_goose_game__Syms.h"
-#include "verilated.h"
+#include "goosegame_sim.h"
+#include "vga_capture.h"
+#include "frame_queue.h"
+#include "input_log.h"
+#include "trace_window.h"
+#include "latency_probe.h"
+#include "stage_timing.h"
 #include <SDL2/SDL.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
-// Standard VGA 640x480 timing
-#define H_TOTAL 800
-#define H_DISPLAY 640
-#define V_TOTAL 525
-#define V_DISPLAY 480
-
-static inline uint32_t expand_2bit(uint32_t x) {
-  // Expand 2-bit color to 8-bit
-  // 00 -> 00000000 (0)
-  // 01 -> 01010101 (85)
-  // 10 -> 10101010 (170)
-  // 11 -> 11111111 (255)
-  return (x << 6) | (x << 4) | (x << 2) | x;
+// Give up waiting for a frame after this many cycles without a vsync edge
+#define CAPTURE_TIMEOUT_CYCLES (4 * FRAME_CYCLES)
+
+// A paced run this far behind real time stops trying to catch up
+#define PACE_MAX_LAG_SECONDS 0.1
+// How often the window title rates are refreshed
+#define TITLE_INTERVAL_SECONDS 0.5
+// Full frames captured before frame skipping or thumbnails take over, so
+// the capture has settled on the visible window
+#define DECIMATE_LOCK_FRAMES 3
+
+// State shared between the simulation thread and the SDL thread
+struct SimShared {
+  FrameQueue frames;
+  std::atomic<uint8_t> ui_in{UI_IDLE};  // input mailbox, written by SDL
+  std::atomic<bool> quit{false};
+  std::atomic<bool> turbo{false};       // no real-time cap, toggled by SDL
+  std::atomic<uint64_t> cycles{0};      // simulated so far, for the rate display
+  InputRecorder* recorder = nullptr;  // --record, used by the sim thread only
+  TraceWindow* trace = nullptr;       // --trace, used by the sim thread only
+  LatencyProbe* latency = nullptr;    // --latency, sim and SDL threads
+  StageTimes timing;                  // per-stage frame times, both threads
+  int poll_lines = 0;                 // --poll-lines, 0 polls once per frame
+  int frame_skip = 1;                 // --frame-skip, present every Nth frame
+  int thumbnail = 0;                  // --thumbnail, sample every Kth pixel and line
+};
+
+// Locks simulated time to wall-clock time at the VGA pixel clock
+class Pacer {
+ public:
+  void reset(uint64_t cycles) {
+    start_ = std::chrono::steady_clock::now();
+    base_ = cycles;
+  }
+
+  // Sleep until the wall-clock time this cycle count is due. When the host
+  // cannot keep up, re-anchor instead of racing later to catch up.
+  void wait(uint64_t cycles) {
+    std::chrono::duration<double> sim_time((cycles - base_) / PIXEL_CLOCK_HZ);
+    auto due = start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(sim_time);
+    auto now = std::chrono::steady_clock::now();
+    if (due > now) {
+      std::this_thread::sleep_until(due);
+      slept_ns_ += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - now).count();
+    }
+    else if (now - due > std::chrono::duration<double>(PACE_MAX_LAG_SECONDS)) reset(cycles);
+  }
+
+  // Time spent sleeping since the last call
+  uint64_t take_slept_ns() {
+    uint64_t ns = slept_ns_;
+    slept_ns_ = 0;
+    return ns;
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  uint64_t base_ = 0;
+  uint64_t slept_ns_ = 0;
+};
+
+// Clocks the model for the sim thread, through the trace window when
+// armed. ui_in is re-read from the mailbox at every frame start (poll())
+// and, with --poll-lines, every M scanlines in between; paced runs also
+// wait for wall-clock time at those polls, so a press is seen within M
+// lines of real time instead of up to a frame. While the latency probe
+// waits for the goose to move the model is clocked one cycle at a time.
+class SimClock {
+ public:
+  SimClock(Vtt_um_goose_game* top, SimShared* shared)
+      : top_(top), shared_(shared), poll_cycles_((uint64_t)shared->poll_lines * H_TOTAL) {}
+
+  uint64_t cycles() const { return cycles_; }
+  uint64_t frame() const { return frame_; }
+  void next_frame() { frame_++; }
+
+  // Pace the mid-frame polls against this pacer, or not at all
+  void set_pacer(Pacer* pacer) { pacer_ = pacer; }
+
+  // Apply the buttons from the mailbox
+  void poll() {
+    top_->ui_in = shared_->ui_in.load(std::memory_order_relaxed);
+    if (shared_->recorder != nullptr) shared_->recorder->log(frame_, cycles_, top_->ui_in);
+    if (shared_->latency != nullptr) shared_->latency->applied(top_, cycles_);
+    next_poll_ = poll_cycles_ > 0 ? cycles_ + poll_cycles_ : UINT64_MAX;
+  }
+
+  void tick() {
+    if (shared_->trace->armed()) shared_->trace->step(top_, frame_, cycles_);
+    else sim_tick(top_);
+    cycles_++;
+    if (shared_->latency != nullptr && shared_->latency->watching()) {
+      shared_->latency->check(top_, cycles_);
+    }
+    if (cycles_ == next_poll_) poll_due();
+  }
+
+  // Clock n cycles with nothing sampled
+  void run(uint64_t n) {
+    while (n > 0) {
+      if (shared_->trace->armed() || (shared_->latency != nullptr && shared_->latency->watching())) {
+        tick();
+        n--;
+        continue;
+      }
+      uint64_t chunk = next_poll_ - cycles_ < n ? next_poll_ - cycles_ : n;
+      sim_tick(top_, (uint32_t)chunk);
+      cycles_ += chunk;
+      n -= chunk;
+      if (cycles_ == next_poll_) poll_due();
+    }
+  }
+
+ private:
+  void poll_due() {
+    if (pacer_ != nullptr) pacer_->wait(cycles_);
+    poll();
+  }
+
+  Vtt_um_goose_game* top_;
+  SimShared* shared_;
+  uint64_t poll_cycles_;
+  uint64_t next_poll_ = UINT64_MAX;
+  uint64_t cycles_ = 0;
+  uint64_t frame_ = 0;
+  Pacer* pacer_ = nullptr;
+};
+
+// Reads every kth pixel of every kth line at the cycle it is driven,
+// computed from the raster the capture locked onto, and only clocks the
+// model in between: no per-cycle sampling, so a thumbnail frame costs
+// little more than clocking. A frame starts right after a vsync edge and
+// ends on the next one, which is checked so a timing change in the RTL
+// falls back to the full capture.
+class ThumbnailSampler {
+ public:
+  explicit ThumbnailSampler(int k) : k_(k) {}
+
+  // Fills out and returns true, or returns false with the model somewhere
+  // in the frame when the vsync edge is not where it was measured
+  bool frame(Vtt_um_goose_game* top, SimClock* clock, const VgaCapture& capture,
+             VideoFrame* out) {
+    const CaptureWindow& win = capture.window();
+    int w = win.width / k_;
+    int h = win.height / k_;
+    out->resize(w, h);
+    if (prev_.size() != out->pixels.size()) {
+      prev_.assign(out->pixels.size(), 0);
+      fresh_ = true;
+    }
+
+    uint64_t at = 0;  // cycles since the vsync edge
+    version_++;
+    for (int y = 0; y < h; y++) {
+      uint8_t* row = out->pixels.data() + (size_t)y * w;
+      for (int x = 0; x < w; x++) {
+        uint64_t due = capture.pixel_offset(win.x + x * k_, win.y + y * k_);
+        clock->run(due - at);
+        at = due;
+        row[x] = top->uo_out & UO_RGB_MASK;
+      }
+      uint8_t* seen = prev_.data() + (size_t)y * w;
+      if (memcmp(row, seen, w) != 0 || fresh_) {
+        memcpy(seen, row, w);
+        out->row_version[y] = version_;
+      }
+      else {
+        out->row_version[y] = row_version_[y];
+      }
+    }
+    row_version_.assign(out->row_version.begin(), out->row_version.end());
+    fresh_ = false;
+    out->version = version_;
+
+    uint64_t end = capture.frame_cycles();
+    clock->run(end - 1 - at);
+    bool before = (top->uo_out & UO_VSYNC_BIT) != 0;
+    clock->run(1);
+    return before && (top->uo_out & UO_VSYNC_BIT) == 0;
+  }
+
+  // Mark every row changed in the next thumbnail, e.g. after relocking.
+  // Versions keep counting so the display never sees them go back.
+  void reset() { fresh_ = true; }
+
+ private:
+  int k_;
+  uint64_t version_ = 0;
+  bool fresh_ = true;
+  std::vector<uint8_t> prev_;
+  std::vector<uint64_t> row_version_;
+};
+
+// Simulation thread: clocks the model and publishes each captured frame,
+// never waiting on the display. Paced mode sleeps between frames to hold
+// real time; frames the display misses are dropped by the queue, simulated
+// cycles never are.
+//
+// Once the capture has locked, frames not presented under --frame-skip
+// are clocked in bulk, and --thumbnail frames come from ThumbnailSampler.
+// Both run from one vsync edge to the next, so the capture stays in phase.
+//
+// Every pass of the loop, one simulated frame, adds its decode and pace
+// time to the stage histograms and the rest as eval.
+static void sim_thread(Vtt_um_goose_game* top, SimShared* shared) {
+  // Frames are located from the sync outputs, no warmup frame needed
+  VgaCapture capture;
+  ThumbnailSampler thumbnails(shared->thumbnail);
+  SimClock clock(top, shared);
+  Pacer pacer;
+  bool paced = false;
+  bool in_phase = false;  // the last cycle clocked was a vsync edge
+  uint64_t decode_ns = 0;
+  capture.set_decode_timer(&decode_ns);
+  uint64_t pass_start = 0;
+
+  while (!shared->quit.load(std::memory_order_relaxed)) {
+    uint64_t now = stage_now_ns();
+    if (pass_start != 0) {
+      uint64_t pace_ns = pacer.take_slept_ns();
+      shared->timing.add(STAGE_EVAL, now - pass_start - decode_ns - pace_ns);
+      shared->timing.add(STAGE_DECODE, decode_ns);
+      shared->timing.add(STAGE_PACE, pace_ns);
+    }
+    pass_start = now;
+    decode_ns = 0;
+
+    clock.poll();
+    uint64_t start_cycle = clock.cycles();
+
+    bool decimate = in_phase && capture.frames() >= DECIMATE_LOCK_FRAMES;
+    if (decimate && clock.frame() % shared->frame_skip != 0) {
+      clock.run(capture.frame_cycles());
+      clock.next_frame();
+    }
+    else if (decimate && shared->thumbnail > 0) {
+      VideoFrame& frame = shared->frames.back();
+      if (!thumbnails.frame(top, &clock, capture, &frame)) {
+        // Syncs moved, relock with the full capture
+        capture.reset();
+        thumbnails.reset();
+        in_phase = false;
+        continue;
+      }
+      frame.number = clock.frame();
+      frame.start_cycle = start_cycle;
+      clock.next_frame();
+      shared->frames.publish();
+    }
+    else {
+      VideoFrame& frame = shared->frames.back();
+      frame.resize(capture.width(), capture.height());
+      capture.set_target(frame.pixels.data(), frame.width);
+
+      // Render one frame: clock until the capture sees the next vsync
+      bool done = false;
+      for (int cycle = 0; cycle < CAPTURE_TIMEOUT_CYCLES && !done; cycle++) {
+        // Clock the system
+        clock.tick();
+        done = capture.sample(top->uo_out);
+      }
+      in_phase = done;
+      if (!done) continue;
+
+      frame.number = clock.frame();
+      frame.start_cycle = start_cycle;
+      clock.next_frame();
+      frame.version = capture.frames() - 1;
+      for (int y = 0; y < frame.height; y++) frame.row_version[y] = capture.row_version(y);
+      // Lock frames are not shown in thumbnail mode, the texture would
+      // flip between sizes
+      if (shared->thumbnail == 0) shared->frames.publish();
+    }
+    shared->cycles.store(clock.cycles(), std::memory_order_relaxed);
+
+    if (shared->turbo.load(std::memory_order_relaxed)) {
+      paced = false;
+      clock.set_pacer(nullptr);
+      continue;
+    }
+    if (!paced) pacer.reset(clock.cycles());
+    paced = true;
+    clock.set_pacer(&pacer);
+    pacer.wait(clock.cycles());
+  }
+
+  if (shared->recorder != nullptr) shared->recorder->finish(clock.frame(), clock.cycles());
+  shared->trace->close();
+}
+
+// Set by SIGUSR1 or the I key, the SDL thread prints the stage times
+static std::atomic<bool> timing_requested{false};
+
+static void request_timing(int) { timing_requested.store(true); }
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --record FILE         log jump/reset changes for goosegame-replay\n"
+          "  --turbo               start without the real-time cap (toggle with T)\n"
+          "  --frame-skip N        decode and present every Nth frame (default 1)\n"
+          "  --thumbnail K         show every Kth pixel and line only\n"
+          "  --poll-lines M        also read the buttons every M scanlines\n"
+          "  --latency FILE        write press-to-jump and press-to-present histograms (JSON)\n"
+          "  --timing FILE         write per-stage frame time histograms (JSON) on exit\n"
+          "  --trace FILE          write an FST trace between the start and stop triggers\n"
+          "  --trace-start TRIG    frame:N, cycle:N or game_over (default: from reset)\n"
+          "  --trace-stop TRIG     frame:N, cycle:N or game_over (default: never)\n",
+          prog);
 }
 
 int main(int argc, char** argv) {
   Verilated::commandArgs(argc, argv);
 
-  Vtt_um_goose_game* top = new Vtt_um_goose_game;
+  const char* record_path = nullptr;
+  const char* trace_path = nullptr;
+  TraceTrigger trace_start, trace_stop;
+  bool turbo = false;
+  int frame_skip = 1;
+  int thumbnail = 0;
+  int poll_lines = 0;
+  const char* latency_path = nullptr;
+  const char* timing_path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool has_value = i + 1 < argc;
+    bool ok = true;
+    if (arg[0] == '+') continue;  // +verilator+ runtime options
+    if (strcmp(arg, "--record") == 0 && has_value) record_path = argv[++i];
+    else if (strcmp(arg, "--turbo") == 0) turbo = true;
+    else if (strcmp(arg, "--frame-skip") == 0 && has_value) ok = (frame_skip = atoi(argv[++i])) > 0;
+    else if (strcmp(arg, "--thumbnail") == 0 && has_value) ok = (thumbnail = atoi(argv[++i])) > 0;
+    else if (strcmp(arg, "--poll-lines") == 0 && has_value) ok = (poll_lines = atoi(argv[++i])) > 0;
+    else if (strcmp(arg, "--latency") == 0 && has_value) latency_path = argv[++i];
+    else if (strcmp(arg, "--timing") == 0 && has_value) timing_path = argv[++i];
+    else if (strcmp(arg, "--trace") == 0 && has_value) trace_path = argv[++i];
+    else if (strcmp(arg, "--trace-start") == 0 && has_value) ok = trace_parse_trigger(argv[++i], &trace_start);
+    else if (strcmp(arg, "--trace-stop") == 0 && has_value) ok = trace_parse_trigger(argv[++i], &trace_stop);
+    else ok = false;
+    if (!ok) {
+      usage(argv[0]);
+      return 2;
+    }
+  }
 
-  // Set default inputs (buttons active-low, so default high = not pressed)
-  top->ui_in = 0xFF;
-  top->uio_in = 0;
-  top->ena = 1;
-  
-  // Reset (active low)
-  top->rst_n = 0;
-  top->clk = 0; top->eval(); 
-  top->clk = 1; top->eval();
-  top->rst_n = 1;
-  top->clk = 0; top->eval();
-  
-  // Run one warmup frame to synchronize VGA counters
-  for(int warmup = 0; warmup < H_TOTAL * V_TOTAL; warmup++) {
-    top->clk = 0; top->eval();
-    top->clk = 1; top->eval();
+  InputRecorder recorder;
+  if (record_path != nullptr && !recorder.open(record_path)) {
+    fprintf(stderr, "Failed to open input log %s\n", record_path);
+    return 1;
   }
 
+  VerilatedContext* contextp = new VerilatedContext;
+  contextp->commandArgs(argc, argv);
+  TraceWindow trace;
+  if (trace_path != nullptr && !trace.configure(contextp, trace_path, trace_start, trace_stop)) {
+    return 1;
+  }
+
+  Vtt_um_goose_game* top = new Vtt_um_goose_game{contextp};
+  trace.attach(top);
+
+  // Set default inputs (buttons active-low, so default high = not pressed) and reset
+  sim_reset(top);
+
   // Initialize SDL
   if (SDL_Init(SDL_INIT_VIDEO) != 0) {
     SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
@@ -50,6 +388,7 @@ int main(int argc, char** argv) {
   }
   
   SDL_SetHint(SDL_HINT_NO_SIGNAL_HANDLERS, "1");
+  signal(SIGUSR1, request_timing);
 
   // Create window
   SDL_Window* window = SDL_CreateWindow("Goose Game - Jump with SPACE",
@@ -71,10 +410,12 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  // Create texture
+  // Create texture, resized below if the capture measures a different raster
+  int texture_w = H_DISPLAY;
+  int texture_h = V_DISPLAY;
   SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, 
                                            SDL_TEXTUREACCESS_STREAMING, 
-                                           H_DISPLAY, V_DISPLAY);
+                                           texture_w, texture_h);
   if (texture == nullptr) {
     SDL_Log("Failed to create texture: %s", SDL_GetError());
     SDL_DestroyRenderer(renderer);
@@ -83,13 +424,37 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  SDL_Log("Controls: SPACE/UP = Jump, R = Reset, ESC = Quit");
+  SDL_Log("Controls: SPACE/UP = Jump, R = Reset, T = Turbo, I = Stage times, ESC = Quit");
+
+  // The model runs on its own thread from here on
+  SimShared shared;
+  if (record_path != nullptr) shared.recorder = &recorder;
+  shared.trace = &trace;
+  shared.turbo.store(turbo);
+  shared.frame_skip = frame_skip;
+  shared.thumbnail = thumbnail;
+  shared.poll_lines = poll_lines;
+  LatencyProbe latency;
+  if (latency_path != nullptr) shared.latency = &latency;
+  std::thread sim(sim_thread, top, &shared);
 
   // Main loop
   bool quit = false;
   uint8_t jump_held = 0;
   uint8_t reset_held = 0;
-  
+
+  // Rates shown in the window title
+  auto title_time = std::chrono::steady_clock::now();
+  uint64_t title_cycles = 0;
+  uint64_t presented = 0;
+
+  // Capture version of the frame in the texture, or none after (re)creating it
+  bool texture_valid = false;
+  uint64_t texture_version = 0;
+
+  // End of the last present, start of the wait stage
+  uint64_t wait_start = stage_now_ns();
+
   while (!quit) {
     // Handle events
     SDL_Event event;
@@ -104,11 +469,18 @@ int main(int argc, char** argv) {
             break;
           case SDLK_SPACE:
           case SDLK_UP:
+            if (!event.key.repeat && shared.latency != nullptr) shared.latency->press();
             jump_held = 1;
             break;
           case SDLK_r:
             reset_held = 1;
             break;
+          case SDLK_t:
+            if (!event.key.repeat) shared.turbo.store(!shared.turbo.load());
+            break;
+          case SDLK_i:
+            if (!event.key.repeat) timing_requested.store(true);
+            break;
         }
       }
       else if (event.type == SDL_KEYUP) {
@@ -124,56 +496,114 @@ int main(int argc, char** argv) {
       }
     }
 
+    if (timing_requested.exchange(false)) shared.timing.print(stderr, shared.frames.dropped());
+
     // Pass raw button state directly (active-low: 0 = pressed, 1 = not pressed)
-    uint8_t jump_low = jump_held ? 0 : 1;
-    uint8_t reset_low = reset_held ? 0 : 1;
-    top->ui_in = 0xFC | (reset_low << 1) | jump_low;
-
-    // Get framebuffer pointer
-    uint32_t* pixels;
-    int pitch;
-    if (SDL_LockTexture(texture, nullptr, (void**)&pixels, &pitch) != 0) {
-      SDL_Log("Failed to lock texture: %s", SDL_GetError());
-      break;
+    shared.ui_in.store(make_ui_in(jump_held, reset_held), std::memory_order_relaxed);
+
+    // Simulated MHz, presented fps and speed relative to real hardware
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - title_time).count();
+    if (elapsed >= TITLE_INTERVAL_SECONDS) {
+      uint64_t cycles = shared.cycles.load(std::memory_order_relaxed);
+      double hz = (cycles - title_cycles) / elapsed;
+      char title[128];
+      snprintf(title, sizeof(title), "Goose Game - %.2f MHz, %.1f fps, %.2fx real time%s",
+               hz / 1e6, presented / elapsed, hz / PIXEL_CLOCK_HZ,
+               shared.turbo.load() ? " [turbo]" : "");
+      SDL_SetWindowTitle(window, title);
+      title_time = now;
+      title_cycles = cycles;
+      presented = 0;
     }
 
-    // Render one frame
-    int k = 0;
-    for(int v = 0; v < V_TOTAL; v++) {
-      for(int h = 0; h < H_TOTAL; h++) {
-        // Clock the system
-        top->clk = 0; top->eval(); 
-        top->clk = 1; top->eval();
-        
-        // Sample outputs in visible area
-        if (v < V_DISPLAY && h < H_DISPLAY) {
-          // Extract 2-bit RGB from uo_out: {hsync, B[0], G[0], R[0], vsync, B[1], G[1], R[1]}
-          // Bit mapping: uo_out[7:0] = {HSync, B0, G0, R0, VSync, B1, G1, R1}
-          uint8_t r = ((top->uo_out & 0x01) << 1) | ((top->uo_out & 0x10) >> 4);  // R1, R0
-          uint8_t g = ((top->uo_out & 0x02) << 0) | ((top->uo_out & 0x20) >> 5);  // G1, G0
-          uint8_t b = ((top->uo_out & 0x04) >> 1) | ((top->uo_out & 0x40) >> 6);  // B1, B0
-          
-          uint32_t color = 0xFF000000 | 
-                          (expand_2bit(r) << 16) | 
-                          (expand_2bit(g) << 8) | 
-                          expand_2bit(b);
-          pixels[k++] = color;
-        }
+    // Show the newest completed frame, if the simulation has finished one
+    const VideoFrame* frame = shared.frames.acquire();
+    if (frame == nullptr) {
+      SDL_Delay(1);
+      continue;
+    }
+
+    // Follow the visible window measured from the sync outputs
+    if (frame->width != texture_w || frame->height != texture_h) {
+      SDL_DestroyTexture(texture);
+      texture_w = frame->width;
+      texture_h = frame->height;
+      texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                  SDL_TEXTUREACCESS_STREAMING,
+                                  texture_w, texture_h);
+      if (texture == nullptr) {
+        SDL_Log("Failed to create texture: %s", SDL_GetError());
+        break;
+      }
+      SDL_Log("Capture window %dx%d", texture_w, texture_h);
+      texture_valid = false;
+    }
+
+    // Upload only runs of rows that changed since the frame in the texture,
+    // expanding the indexed rows to ARGB straight into the locked texture
+    uint64_t upload_start = stage_now_ns();
+    bool upload_ok = true;
+    for (int y = 0; y < frame->height && upload_ok;) {
+      if (texture_valid && frame->row_version[y] <= texture_version) {
+        y++;
+        continue;
+      }
+      int end = y + 1;
+      while (end < frame->height &&
+             (!texture_valid || frame->row_version[end] > texture_version)) {
+        end++;
+      }
+      SDL_Rect rows = {0, y, frame->width, end - y};
+      void* locked;
+      int pitch;
+      upload_ok = SDL_LockTexture(texture, &rows, &locked, &pitch) == 0;
+      if (!upload_ok) break;
+      for (int row = y; row < end; row++) {
+        pmod_expand_indexed(frame->pixels.data() + (size_t)row * frame->width,
+                            (uint32_t*)((uint8_t*)locked + (size_t)(row - y) * pitch), frame->width);
       }
+      SDL_UnlockTexture(texture);
+      y = end;
     }
-    
-    SDL_UnlockTexture(texture);
+    if (!upload_ok) {
+      SDL_Log("Failed to update texture: %s", SDL_GetError());
+      break;
+    }
+    texture_valid = true;
+    texture_version = frame->version;
+    uint64_t copy_start = stage_now_ns();
     SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    uint64_t present_start = stage_now_ns();
     SDL_RenderPresent(renderer);
+    uint64_t present_end = stage_now_ns();
+    shared.timing.add(STAGE_WAIT, upload_start - wait_start);
+    shared.timing.add(STAGE_UPLOAD, copy_start - upload_start);
+    shared.timing.add(STAGE_COPY, present_start - copy_start);
+    shared.timing.add(STAGE_PRESENT, present_end - present_start);
+    wait_start = present_end;
+    presented++;
+    if (shared.latency != nullptr) shared.latency->presented(frame->start_cycle);
+  }
+
+  shared.quit.store(true);
+  sim.join();
+  if (latency_path != nullptr && !latency.write(latency_path)) {
+    fprintf(stderr, "Failed to write latency histograms to %s\n", latency_path);
+  }
+  shared.timing.print(stderr, shared.frames.dropped());
+  if (timing_path != nullptr && !shared.timing.write(timing_path, shared.frames.dropped())) {
+    fprintf(stderr, "Failed to write stage times to %s\n", timing_path);
   }
 
   // Cleanup
-  SDL_DestroyTexture(texture);
+  if (texture != nullptr) SDL_DestroyTexture(texture);
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
   SDL_Quit();
   
   delete top;
+  delete contextp;
 
   return 0;
 }
@@ -0,0 +1,85 @@
+/*
+ * Histogram for latencies and other non-negative integer samples.
+ *
+ * Buckets are log-spaced, 8 per power of two (exact below 8), so memory
+ * is fixed however many samples are added. Percentiles report the upper
+ * edge of their bucket and are within 1/8 of the true value; max is exact.
+ * Units are the caller's, e.g. microseconds or cycles.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HISTOGRAM_SUB_BUCKETS 8
+// Covers samples up to 2^48
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_BUCKETS * 46)
+
+class Histogram {
+ public:
+  Histogram() { memset(counts_, 0, sizeof(counts_)); }
+
+  void add(uint64_t v) {
+    counts_[index(v)]++;
+    count_++;
+    if (v > max_) max_ = v;
+  }
+
+  uint64_t count() const { return count_; }
+  uint64_t max() const { return max_; }
+
+  // Upper bucket edge below which fraction p of the samples fall
+  uint64_t percentile(double p) const {
+    if (count_ == 0) return 0;
+    uint64_t rank = (uint64_t)(p * count_);
+    if (rank >= count_) rank = count_ - 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+      seen += counts_[i];
+      if (seen > rank) return upper(i) < max_ ? upper(i) : max_;
+    }
+    return max_;
+  }
+
+  // {"count": N, "p50": .., "p99": .., "max": .., "buckets": [[le, n], ...]}
+  // with only the non-empty buckets listed
+  void write_json(FILE* f) const {
+    fprintf(f, "{\"count\": %llu, \"p50\": %llu, \"p99\": %llu, \"max\": %llu, \"buckets\": [",
+            (unsigned long long)count_, (unsigned long long)percentile(0.50),
+            (unsigned long long)percentile(0.99), (unsigned long long)max_);
+    bool first = true;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+      if (counts_[i] == 0) continue;
+      fprintf(f, "%s[%llu, %llu]", first ? "" : ", ", (unsigned long long)upper(i),
+              (unsigned long long)counts_[i]);
+      first = false;
+    }
+    fprintf(f, "]}");
+  }
+
+ private:
+  static int index(uint64_t v) {
+    if (v < HISTOGRAM_SUB_BUCKETS) return (int)v;
+    int e = 63 - __builtin_clzll(v);  // v >= 8, so e >= 3
+    int sub = (int)(v >> (e - 3)) - HISTOGRAM_SUB_BUCKETS;
+    int i = HISTOGRAM_SUB_BUCKETS + (e - 3) * HISTOGRAM_SUB_BUCKETS + sub;
+    return i < HISTOGRAM_BUCKETS ? i : HISTOGRAM_BUCKETS - 1;
+  }
+
+  // Largest sample that lands in bucket i
+  static uint64_t upper(int i) {
+    if (i < HISTOGRAM_SUB_BUCKETS) return (uint64_t)i;
+    int e = (i - HISTOGRAM_SUB_BUCKETS) / HISTOGRAM_SUB_BUCKETS + 3;
+    int sub = (i - HISTOGRAM_SUB_BUCKETS) % HISTOGRAM_SUB_BUCKETS;
+    return ((uint64_t)(HISTOGRAM_SUB_BUCKETS + sub + 1) << (e - 3)) - 1;
+  }
+
+  uint64_t counts_[HISTOGRAM_BUCKETS];
+  uint64_t count_ = 0;
+  uint64_t max_ = 0;
+};
+
+#endif
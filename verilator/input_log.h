@@ -0,0 +1,154 @@
+/*
+ * Input record/replay for deterministic headless runs.
+ *
+ * A log is plain text, one event per line:
+ *   <frame> <cycle> <ui_in in hex>
+ * where cycle counts design clock cycles since reset. Events are only
+ * written when the jump or reset bit changes. A final "end <frame> <cycle>"
+ * line marks where recording stopped so a replay runs the same length.
+ */
+
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "goosegame_sim.h"
+#include "game_state.h"
+
+#define INPUT_LOG_HEADER "# goosegame input log v1"
+#define INPUT_LOG_BITS (UI_JUMP_BIT | UI_RESET_BIT)
+
+struct InputEvent {
+  uint64_t frame;
+  uint64_t cycle;
+  uint8_t ui_in;
+};
+
+struct InputLog {
+  std::vector<InputEvent> events;
+  uint64_t end_frame = 0;
+  uint64_t end_cycle = 0;
+};
+
+class InputRecorder {
+ public:
+  ~InputRecorder() { close(); }
+
+  bool open(const char* path) {
+    file_ = fopen(path, "w");
+    if (file_ == nullptr) return false;
+    fprintf(file_, "%s\n", INPUT_LOG_HEADER);
+    last_ = UI_IDLE;
+    return true;
+  }
+
+  // Call whenever ui_in is applied to the model
+  void log(uint64_t frame, uint64_t cycle, uint8_t ui_in) {
+    if (file_ == nullptr || ((ui_in ^ last_) & INPUT_LOG_BITS) == 0) return;
+    fprintf(file_, "%llu %llu %02x\n", (unsigned long long)frame,
+            (unsigned long long)cycle, ui_in);
+    last_ = ui_in;
+  }
+
+  void finish(uint64_t frame, uint64_t cycle) {
+    if (file_ == nullptr) return;
+    fprintf(file_, "end %llu %llu\n", (unsigned long long)frame, (unsigned long long)cycle);
+    close();
+  }
+
+ private:
+  void close() {
+    if (file_ != nullptr) fclose(file_);
+    file_ = nullptr;
+  }
+
+  FILE* file_ = nullptr;
+  uint8_t last_ = UI_IDLE;
+};
+
+static inline bool input_log_load(const char* path, InputLog* log) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) return false;
+
+  char line[128];
+  bool ok = fgets(line, sizeof(line), f) != nullptr &&
+            strncmp(line, INPUT_LOG_HEADER, strlen(INPUT_LOG_HEADER)) == 0;
+  bool ended = false;
+  while (ok && fgets(line, sizeof(line), f) != nullptr) {
+    unsigned long long frame, cycle;
+    unsigned ui_in;
+    if (sscanf(line, "end %llu %llu", &frame, &cycle) == 2) {
+      log->end_frame = frame;
+      log->end_cycle = cycle;
+      ended = true;
+    }
+    else if (sscanf(line, "%llu %llu %x", &frame, &cycle, &ui_in) == 3) {
+      InputEvent ev = {frame, cycle, (uint8_t)ui_in};
+      ok = log->events.empty() || cycle >= log->events.back().cycle;
+      log->events.push_back(ev);
+    }
+    else if (line[0] != '#' && line[0] != '\n') {
+      ok = false;
+    }
+  }
+  fclose(f);
+
+  if (ok && !ended) {
+    // Truncated log: stop one frame after the last event
+    log->end_cycle = log->events.empty() ? 0 : log->events.back().cycle + FRAME_CYCLES;
+    log->end_frame = log->end_cycle / FRAME_CYCLES;
+  }
+  return ok;
+}
+
+// Applies the events of a log to a model as its cycle count advances
+class InputPlayer {
+ public:
+  explicit InputPlayer(const InputLog& log) : log_(log) {}
+
+  // Apply every event due at or before this cycle and return the cycle of
+  // the next one (or the end of the log)
+  uint64_t apply(Vtt_um_goose_game* top, uint64_t cycle) {
+    while (next_ < log_.events.size() && log_.events[next_].cycle <= cycle) {
+      top->ui_in = log_.events[next_++].ui_in;
+    }
+    uint64_t stop = next_ < log_.events.size() ? log_.events[next_].cycle : log_.end_cycle;
+    return stop < log_.end_cycle ? stop : log_.end_cycle;
+  }
+
+ private:
+  const InputLog& log_;
+  size_t next_ = 0;
+};
+
+// Run a freshly reset model through a log as fast as it goes: no display,
+// no pacing, the model is clocked in bulk between input changes and frame
+// boundaries. The game state at the end of every frame goes to telemetry
+// and is checked against the lockstep model. Returns false at the first
+// lockstep divergence. A model restored from a checkpoint continues from
+// start_cycle.
+static inline bool input_log_replay(Vtt_um_goose_game* top, const InputLog& log,
+                                    TelemetryLog* telemetry = nullptr,
+                                    Lockstep* lockstep = nullptr, uint64_t start_cycle = 0) {
+  InputPlayer player(log);
+  uint64_t cycle = start_cycle;
+  while (cycle < log.end_cycle) {
+    uint64_t stop = player.apply(top, cycle);
+    while (cycle < stop) {
+      uint64_t frame_end = (cycle / FRAME_CYCLES + 1) * FRAME_CYCLES;
+      uint64_t n = (stop < frame_end ? stop : frame_end) - cycle;
+      sim_tick(top, (uint32_t)n);
+      if (lockstep != nullptr) lockstep->advance(n, top->ui_in);
+      cycle += n;
+      if (cycle != frame_end) continue;
+      if (telemetry != nullptr) telemetry->write(cycle / FRAME_CYCLES - 1, cycle, game_state(top));
+      if (lockstep != nullptr && !lockstep->check(top, cycle / FRAME_CYCLES - 1)) return false;
+    }
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * Input-to-photon latency probe for the interactive simulation.
+ *
+ * Follows one jump press at a time through the harness:
+ *   press      the SDL thread sees the key go down
+ *   input      the sim thread applies it to ui_in
+ *   jump       jump_pos first leaves 0, in wall time and in design cycles
+ *              since the input was applied
+ *   present    the first frame that started after that cycle is presented
+ * Each stage is measured from the press and collected in a Histogram.
+ * "present" counts only frames drawn entirely after the change, so it is
+ * a bound at most one frame late.
+ *
+ * Presses while the goose is in the air are not measured. A press that
+ * does not start a jump within LATENCY_TIMEOUT_FRAMES (e.g. at game over)
+ * is counted and dropped. A tap released before the sim thread polled it
+ * never reaches ui_in; the next keydown then restarts the measurement
+ * and the tap is counted as missed.
+ *
+ * press() is called from the SDL thread, presented() from the display
+ * loop, the rest from the sim thread.
+ */
+
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include "goosegame_sim.h"
+#include "histogram.h"
+
+#define LATENCY_TIMEOUT_FRAMES 4
+
+class LatencyProbe {
+ public:
+  void press() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pressed_.load(std::memory_order_relaxed)) missed_++;
+    else if (pending_) return;  // already in ui_in, being followed
+    pending_ = true;
+    press_time_ = std::chrono::steady_clock::now();
+    pressed_.store(true, std::memory_order_release);
+  }
+
+  // ui_in was just applied to the model at this cycle
+  void applied(Vtt_um_goose_game* top, uint64_t cycle) {
+    if (watching_ || !pressed_.load(std::memory_order_acquire)) return;
+    if ((top->ui_in & UI_JUMP_BIT) != 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    pressed_.store(false, std::memory_order_relaxed);
+    if (SIM_JUMP_POS(top) != 0) {
+      airborne_++;
+      pending_ = false;
+      return;
+    }
+    input_us_.add(since_press());
+    watching_ = true;
+    apply_cycle_ = cycle;
+  }
+
+  // While watching(), call after every cycle
+  bool watching() const { return watching_; }
+
+  void check(Vtt_um_goose_game* top, uint64_t cycle) {
+    if (SIM_JUMP_POS(top) != 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jump_us_.add(since_press());
+      jump_cycles_.add(cycle - apply_cycle_);
+      change_cycle_ = cycle;
+      watching_ = false;
+      showing_.store(true, std::memory_order_release);
+    }
+    else if (cycle - apply_cycle_ > (uint64_t)LATENCY_TIMEOUT_FRAMES * FRAME_CYCLES) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      no_jump_++;
+      watching_ = false;
+      pending_ = false;
+    }
+  }
+
+  // A frame that started at this cycle is on screen
+  void presented(uint64_t start_cycle) {
+    if (!showing_.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (start_cycle < change_cycle_) return;
+    present_us_.add(since_press());
+    showing_.store(false, std::memory_order_relaxed);
+    pending_ = false;
+  }
+
+  bool write(const char* path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FILE* f = fopen(path, "w");
+    if (f == nullptr) return false;
+    fprintf(f, "{\"presses\": %llu, \"airborne\": %llu, \"no_jump\": %llu, \"missed\": %llu,\n",
+            (unsigned long long)(input_us_.count() + airborne_ + missed_),
+            (unsigned long long)airborne_, (unsigned long long)no_jump_,
+            (unsigned long long)missed_);
+    fprintf(f, " \"press_to_input_us\": ");
+    input_us_.write_json(f);
+    fprintf(f, ",\n \"press_to_jump_us\": ");
+    jump_us_.write_json(f);
+    fprintf(f, ",\n \"input_to_jump_cycles\": ");
+    jump_cycles_.write_json(f);
+    fprintf(f, ",\n \"press_to_present_us\": ");
+    present_us_.write_json(f);
+    fprintf(f, "}\n");
+    return fclose(f) == 0;
+  }
+
+ private:
+  uint64_t since_press() const {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - press_time_);
+    return (uint64_t)us.count();
+  }
+
+  std::mutex mutex_;
+  std::atomic<bool> pressed_{false};  // press not yet seen in ui_in
+  std::atomic<bool> showing_{false};  // jump started, not yet presented
+  bool pending_ = false;              // a press is being followed
+  std::chrono::steady_clock::time_point press_time_;
+  uint64_t change_cycle_ = 0;
+
+  // Sim thread only
+  bool watching_ = false;
+  uint64_t apply_cycle_ = 0;
+
+  uint64_t airborne_ = 0;
+  uint64_t no_jump_ = 0;
+  uint64_t missed_ = 0;
+  Histogram input_us_;
+  Histogram jump_us_;
+  Histogram jump_cycles_;
+  Histogram present_us_;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#!/bin/sh
+#
+# Build the headless bench on Verilator's multithreaded scheduler at several
+# thread counts, run the same scenario on each and report the speedup over
+# one thread. With PROFILE=1 the partition is also profiled with --prof-exec
+# and summarised by verilator_gantt.
+#
+# Environment: THREAD_COUNTS (default "1 2 4 8"), SCENARIO (default idle),
+#              FRAMES (default 120), PROFILE (default 0), THREADS (profiled
+#              thread count, default 4)
+
+set -e
+cd "$(dirname "$0")"
+
+THREAD_COUNTS="${THREAD_COUNTS:-1 2 4 8}"
+SCENARIO="${SCENARIO:-idle}"
+FRAMES="${FRAMES:-120}"
+THREADS="${THREADS:-4}"
+MAKE="${MAKE:-make}"
+
+cycles_per_sec() {
+    sed -n 's/.*"cycles_per_sec": \([0-9.]*\).*/\1/p' "$1" | head -n 1
+}
+
+base=""
+best=1
+best_threads=1
+printf '%-8s %16s %9s %11s\n' threads cycles/sec speedup efficiency
+for n in $THREAD_COUNTS; do
+    $MAKE -s "goosegame-bench-mt$n" > /dev/null
+    ./"goosegame-bench-mt$n" --scenario "$SCENARIO" --frames "$FRAMES" \
+        --out "mt_scaling_$n.json" > /dev/null 2>&1
+    cps=$(cycles_per_sec "mt_scaling_$n.json")
+    [ -z "$base" ] && base=$cps
+    speedup=$(awk -v c="$cps" -v b="$base" 'BEGIN { printf "%.2f", c / b }')
+    awk -v n="$n" -v c="$cps" -v s="$speedup" \
+        'BEGIN { printf "%-8s %16.0f %8.2fx %10.0f%%\n", n, c, s, 100 * s / n }'
+    if awk -v s="$speedup" -v b="$best" 'BEGIN { exit !(s > b) }'; then
+        best=$speedup
+        best_threads=$n
+    fi
+done
+
+echo
+if awk -v b="$best" 'BEGIN { exit !(b >= 1.10) }'; then
+    echo "Partition scales: best ${best}x at $best_threads threads."
+else
+    echo "Partition does not scale: extra threads only add synchronisation overhead,"
+    echo "so run one single-threaded model per worker core instead."
+fi
+
+if [ "${PROFILE:-0}" = "1" ]; then
+    echo
+    echo "Profiling the $THREADS-thread partition..."
+    $MAKE -s goosegame-bench-prof-mt THREADS="$THREADS" > /dev/null
+    ./goosegame-bench-prof-mt --scenario "$SCENARIO" --frames 4 \
+        +verilator+prof+exec+file+profile_exec.dat \
+        +verilator+prof+exec+start+0 +verilator+prof+exec+window+1000 > /dev/null 2>&1
+    verilator_gantt --no-vcd profile_exec.dat
+fi
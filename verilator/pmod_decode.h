@@ -0,0 +1,155 @@
+/*
+ * TinyVGA PMOD pixel decode.
+ *
+ * The one place that knows how uo_out is wired:
+ *   uo_out[7:0] = {HSync, B0, G0, R0, VSync, B1, G1, R1}
+ * Every consumer of pixels (SDL display, video export, frame hashing) goes
+ * through these helpers.
+ *
+ * Single pixels are decoded through a 256-entry uo_out -> ARGB8888 table.
+ * Whole scanlines of raw uo_out bytes are converted 16 at a time with SSE2
+ * or NEON, falling back to the table elsewhere.
+ *
+ * Frames are kept indexed, one byte per pixel: the color bits of uo_out
+ * with the syncs masked off (uo_out & UO_RGB_MASK, 64 colors). An index is
+ * itself a valid uo_out byte, so the same table and scanline decoder
+ * expand indexed pixels to ARGB8888 where a display needs them.
+ */
+
+#ifndef PMOD_DECODE_H
+#define PMOD_DECODE_H
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// uo_out bits
+#define UO_R1_BIT 0x01
+#define UO_G1_BIT 0x02
+#define UO_B1_BIT 0x04
+#define UO_VSYNC_BIT 0x08
+#define UO_R0_BIT 0x10
+#define UO_G0_BIT 0x20
+#define UO_B0_BIT 0x40
+#define UO_HSYNC_BIT 0x80
+#define UO_RGB_MASK 0x77
+
+static inline uint32_t expand_2bit(uint32_t x) {
+  // Expand 2-bit color to 8-bit
+  // 00 -> 00000000 (0)
+  // 01 -> 01010101 (85)
+  // 10 -> 10101010 (170)
+  // 11 -> 11111111 (255)
+  return (x << 6) | (x << 4) | (x << 2) | x;
+}
+
+// 6-bit RGB222 color code {R1, R0, G1, G0, B1, B0}
+static inline uint8_t pmod_rgb222(uint8_t uo_out) {
+  uint8_t r = ((uo_out & UO_R1_BIT) << 1) | ((uo_out & UO_R0_BIT) >> 4);  // R1, R0
+  uint8_t g = ((uo_out & UO_G1_BIT) << 0) | ((uo_out & UO_G0_BIT) >> 5);  // G1, G0
+  uint8_t b = ((uo_out & UO_B1_BIT) >> 1) | ((uo_out & UO_B0_BIT) >> 6);  // B1, B0
+  return (r << 4) | (g << 2) | b;
+}
+
+static inline uint32_t rgb222_to_argb(uint8_t code) {
+  return 0xFF000000 |
+         (expand_2bit((code >> 4) & 3) << 16) |
+         (expand_2bit((code >> 2) & 3) << 8) |
+         expand_2bit(code & 3);
+}
+
+struct PmodArgbTable {
+  uint32_t argb[256];
+
+  PmodArgbTable() {
+    for (int i = 0; i < 256; i++) argb[i] = rgb222_to_argb(pmod_rgb222((uint8_t)i));
+  }
+};
+
+static inline const uint32_t* pmod_argb_table() {
+  static const PmodArgbTable table;
+  return table.argb;
+}
+
+static inline uint32_t pmod_argb(uint8_t uo_out) {
+  return pmod_argb_table()[uo_out];
+}
+
+// Convert n raw uo_out bytes to ARGB8888. Each channel is the MSB bit worth
+// 0xAA plus the LSB bit worth 0x55, so it needs only bit tests and masks.
+static inline void pmod_decode_scanline(const uint8_t* src, uint32_t* dst, int n) {
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128i alpha = _mm_set1_epi8((char)0xFF);
+  const __m128i msb_weight = _mm_set1_epi8((char)0xAA);
+  const __m128i lsb_weight = _mm_set1_epi8(0x55);
+  const __m128i r1 = _mm_set1_epi8(UO_R1_BIT), r0 = _mm_set1_epi8(UO_R0_BIT);
+  const __m128i g1 = _mm_set1_epi8(UO_G1_BIT), g0 = _mm_set1_epi8(UO_G0_BIT);
+  const __m128i b1 = _mm_set1_epi8(UO_B1_BIT), b0 = _mm_set1_epi8(UO_B0_BIT);
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+#define PMOD_CHANNEL(hi, lo) \
+    _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(v, hi), hi), msb_weight), \
+                 _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(v, lo), lo), lsb_weight))
+    __m128i r = PMOD_CHANNEL(r1, r0);
+    __m128i g = PMOD_CHANNEL(g1, g0);
+    __m128i b = PMOD_CHANNEL(b1, b0);
+#undef PMOD_CHANNEL
+    // Interleave to little-endian ARGB8888 (B, G, R, A in memory)
+    __m128i bg_lo = _mm_unpacklo_epi8(b, g), bg_hi = _mm_unpackhi_epi8(b, g);
+    __m128i ra_lo = _mm_unpacklo_epi8(r, alpha), ra_hi = _mm_unpackhi_epi8(r, alpha);
+    _mm_storeu_si128((__m128i*)(dst + i + 0), _mm_unpacklo_epi16(bg_lo, ra_lo));
+    _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_unpackhi_epi16(bg_lo, ra_lo));
+    _mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpacklo_epi16(bg_hi, ra_hi));
+    _mm_storeu_si128((__m128i*)(dst + i + 12), _mm_unpackhi_epi16(bg_hi, ra_hi));
+  }
+#elif defined(__ARM_NEON)
+  const uint8x16_t msb_weight = vdupq_n_u8(0xAA);
+  const uint8x16_t lsb_weight = vdupq_n_u8(0x55);
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t v = vld1q_u8(src + i);
+#define PMOD_CHANNEL(hi, lo) \
+    vorrq_u8(vandq_u8(vtstq_u8(v, vdupq_n_u8(hi)), msb_weight), \
+             vandq_u8(vtstq_u8(v, vdupq_n_u8(lo)), lsb_weight))
+    uint8x16x4_t argb;
+    argb.val[0] = PMOD_CHANNEL(UO_B1_BIT, UO_B0_BIT);
+    argb.val[1] = PMOD_CHANNEL(UO_G1_BIT, UO_G0_BIT);
+    argb.val[2] = PMOD_CHANNEL(UO_R1_BIT, UO_R0_BIT);
+    argb.val[3] = vdupq_n_u8(0xFF);
+#undef PMOD_CHANNEL
+    vst4q_u8((uint8_t*)(dst + i), argb);
+  }
+#endif
+  const uint32_t* table = pmod_argb_table();
+  for (; i < n; i++) dst[i] = table[src[i]];
+}
+
+// Convert n raw uo_out bytes to palette indices
+static inline void pmod_index_scanline(const uint8_t* src, uint8_t* dst, int n) {
+  // Plain loop, vectorized by the compiler
+  for (int i = 0; i < n; i++) dst[i] = src[i] & UO_RGB_MASK;
+}
+
+// Expand n palette indices to ARGB8888
+static inline void pmod_expand_indexed(const uint8_t* src, uint32_t* dst, int n) {
+  pmod_decode_scanline(src, dst, n);
+}
+
+// First and last index of a non-black pixel in n raw bytes, or false if
+// the whole span is black (blanking)
+static inline bool pmod_active_span(const uint8_t* src, int n, int* first, int* last) {
+  int f = 0;
+  while (f < n && (src[f] & UO_RGB_MASK) == 0) f++;
+  if (f == n) return false;
+  int l = n - 1;
+  while ((src[l] & UO_RGB_MASK) == 0) l--;
+  *first = f;
+  *last = l;
+  return true;
+}
+
+#endif
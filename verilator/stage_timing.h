@@ -0,0 +1,86 @@
+/*
+ * Per-stage frame timing for the interactive simulation.
+ *
+ * Each thread times its own stages once per frame and adds the totals
+ * here, one Histogram per stage in nanoseconds:
+ *   eval     sim thread, clocking the model (everything but decode)
+ *   decode   sim thread, scanline decode and row compare in VgaCapture
+ *   pace     sim thread, sleeping to hold real time
+ *   wait     SDL thread, events and waiting for the next frame
+ *   upload   SDL thread, lock, expand and unlock of the dirty rows
+ *   copy     SDL thread, SDL_RenderCopy
+ *   present  SDL thread, SDL_RenderPresent (vsync waits land here)
+ * A host behind because of the sim shows eval near the frame time and
+ * pace near 0; one behind because of the display shows upload, copy or
+ * present there, with dropped frames.
+ */
+
+#ifndef STAGE_TIMING_H
+#define STAGE_TIMING_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <mutex>
+#include "histogram.h"
+
+enum Stage {
+  STAGE_EVAL,
+  STAGE_DECODE,
+  STAGE_PACE,
+  STAGE_WAIT,
+  STAGE_UPLOAD,
+  STAGE_COPY,
+  STAGE_PRESENT,
+  STAGE_COUNT
+};
+
+static const char* const STAGE_NAMES[STAGE_COUNT] = {
+  "eval", "decode", "pace", "wait", "upload", "copy", "present"
+};
+
+static inline uint64_t stage_now_ns() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class StageTimes {
+ public:
+  // Time one frame spent in a stage
+  void add(Stage stage, uint64_t ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stages_[stage].add(ns);
+  }
+
+  // Table in milliseconds, with the frames the display dropped
+  void print(FILE* f, uint64_t dropped) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fprintf(f, "%-8s %8s %9s %9s %9s\n", "stage", "frames", "p50 ms", "p99 ms", "max ms");
+    for (int i = 0; i < STAGE_COUNT; i++) {
+      const Histogram& h = stages_[i];
+      fprintf(f, "%-8s %8llu %9.3f %9.3f %9.3f\n", STAGE_NAMES[i], (unsigned long long)h.count(),
+              h.percentile(0.50) / 1e6, h.percentile(0.99) / 1e6, h.max() / 1e6);
+    }
+    fprintf(f, "dropped %llu frames\n", (unsigned long long)dropped);
+  }
+
+  // {"dropped": N, "eval_ns": {histogram}, ...}
+  bool write(const char* path, uint64_t dropped) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FILE* f = fopen(path, "w");
+    if (f == nullptr) return false;
+    fprintf(f, "{\"dropped\": %llu", (unsigned long long)dropped);
+    for (int i = 0; i < STAGE_COUNT; i++) {
+      fprintf(f, ",\n \"%s_ns\": ", STAGE_NAMES[i]);
+      stages_[i].write_json(f);
+    }
+    fprintf(f, "}\n");
+    return fclose(f) == 0;
+  }
+
+ private:
+  std::mutex mutex_;
+  Histogram stages_[STAGE_COUNT];
+};
+
+#endif
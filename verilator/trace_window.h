@@ -0,0 +1,158 @@
+/*
+ * Windowed FST tracing.
+ *
+ * Tracing a whole session produces gigabytes, so a trace is opened and
+ * closed at run time between two triggers:
+ *   frame:N     the start of frame N
+ *   cycle:N     design cycle N since reset
+ *   game_over   the cycle game_over rises
+ * The trace file is only opened at the start trigger. FST writing runs on
+ * Verilator's trace thread (--trace-threads), not the simulation thread.
+ *
+ * Without --trace the model never enables tracing and the harness loop
+ * only pays for one armed() test per cycle. Build with TRACE_FLAGS= for a
+ * model with no trace code at all.
+ */
+
+#ifndef TRACE_WINDOW_H
+#define TRACE_WINDOW_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "goosegame_sim.h"
+#if VM_TRACE_FST
+#include "verilated_fst_c.h"
+#endif
+
+// Signal depth passed to trace()
+#define TRACE_DEPTH 99
+
+enum TraceTriggerKind {
+  TRACE_IMMEDIATE,  // start: from reset, stop: never
+  TRACE_AT_FRAME,
+  TRACE_AT_CYCLE,
+  TRACE_ON_GAME_OVER,
+};
+
+struct TraceTrigger {
+  TraceTriggerKind kind = TRACE_IMMEDIATE;
+  uint64_t value = 0;
+};
+
+// "frame:N", "cycle:N" or "game_over"
+static inline bool trace_parse_trigger(const char* text, TraceTrigger* t) {
+  char* end;
+  if (strcmp(text, "game_over") == 0) {
+    t->kind = TRACE_ON_GAME_OVER;
+    return true;
+  }
+  if (strncmp(text, "frame:", 6) == 0) t->kind = TRACE_AT_FRAME;
+  else if (strncmp(text, "cycle:", 6) == 0) t->kind = TRACE_AT_CYCLE;
+  else return false;
+  t->value = strtoull(text + 6, &end, 10);
+  return end != text + 6 && *end == '\0';
+}
+
+class TraceWindow {
+ public:
+  ~TraceWindow() { close(); }
+
+  // Call before the model is constructed
+  bool configure(VerilatedContext* contextp, const char* path, TraceTrigger start,
+                 TraceTrigger stop) {
+#if VM_TRACE_FST
+    contextp->traceEverOn(true);
+    path_ = path;
+    start_ = start;
+    stop_ = stop;
+    state_ = WAITING;
+    return true;
+#else
+    (void)contextp;
+    (void)start;
+    (void)stop;
+    fprintf(stderr, "trace: %s not written, model built without --trace-fst\n", path);
+    return false;
+#endif
+  }
+
+  void attach(Vtt_um_goose_game* top) {
+#if VM_TRACE_FST
+    if (state_ != WAITING) return;
+    top->trace(&fst_, TRACE_DEPTH);
+    game_over_ = SIM_GAME_OVER(top);
+#else
+    (void)top;
+#endif
+  }
+
+  // True until the window has closed. Only then step() is needed.
+  bool armed() const { return state_ == WAITING || state_ == TRACING; }
+  bool tracing() const { return state_ == TRACING; }
+
+  // Advance one design cycle, checking the triggers first. Inside the
+  // window both clock edges are evaluated so the waveform shows clk.
+  void step(Vtt_um_goose_game* top, uint64_t frame, uint64_t cycle) {
+#if VM_TRACE_FST
+    bool game_over = SIM_GAME_OVER(top);
+    bool rose = game_over && !game_over_;
+    game_over_ = game_over;
+    if (state_ == WAITING && fires(start_, frame, cycle, rose)) {
+      fst_.open(path_);
+      state_ = TRACING;
+      fprintf(stderr, "trace: started at frame %llu cycle %llu\n", (unsigned long long)frame,
+              (unsigned long long)cycle);
+    }
+    else if (state_ == TRACING && stop_.kind != TRACE_IMMEDIATE && fires(stop_, frame, cycle, rose)) {
+      fprintf(stderr, "trace: stopped at frame %llu cycle %llu\n", (unsigned long long)frame,
+              (unsigned long long)cycle);
+      close();
+    }
+    if (state_ != TRACING) {
+      sim_tick(top);
+      return;
+    }
+    top->clk = 0; top->eval_step(); top->eval_end_step();
+    fst_.dump(2 * cycle);
+    top->clk = 1; top->eval_step(); top->eval_end_step();
+    fst_.dump(2 * cycle + 1);
+#else
+    (void)frame;
+    (void)cycle;
+    sim_tick(top);
+#endif
+  }
+
+  void close() {
+#if VM_TRACE_FST
+    if (state_ == TRACING) fst_.close();
+#endif
+    if (state_ != OFF) state_ = DONE;
+  }
+
+ private:
+  enum State { OFF, WAITING, TRACING, DONE };
+
+  static bool fires(const TraceTrigger& t, uint64_t frame, uint64_t cycle, bool game_over_rose) {
+    switch (t.kind) {
+      case TRACE_IMMEDIATE: return true;
+      case TRACE_AT_FRAME: return frame >= t.value;
+      case TRACE_AT_CYCLE: return cycle >= t.value;
+      case TRACE_ON_GAME_OVER: return game_over_rose;
+    }
+    return false;
+  }
+
+#if VM_TRACE_FST
+  VerilatedFstC fst_;
+#endif
+  const char* path_ = nullptr;
+  TraceTrigger start_;
+  TraceTrigger stop_;
+  State state_ = OFF;
+  bool game_over_ = false;
+};
+
+#endif
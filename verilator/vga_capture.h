@@ -0,0 +1,241 @@
+/*
+ * Sync-locked VGA frame capture.
+ *
+ * Finds line and frame starts from the falling edges of hsync (uo_out[7])
+ * and vsync (uo_out[3]) instead of assuming a fixed 800x525 raster, so
+ * timing or pipeline-delay changes in the RTL do not tear or shift the
+ * picture. The visible window is learned from where the design drives
+ * non-black pixels between syncs and only moves once two consecutive
+ * frames agree on it.
+ *
+ * Raw uo_out bytes are buffered per scanline and decoded in bulk when the
+ * line ends, so the per-cycle cost is a sync check and a byte store. The
+ * target is normally an indexed frame (pmod_decode.h), one byte per
+ * pixel; ARGB8888 targets are decoded in the same pass for callers that
+ * hand the frame straight to someone else.
+ *
+ * Each visible row is also compared with the same row of the previous
+ * frame, and row_version(y) records the last frame in which it changed, so
+ * a display only needs to upload rows newer than what it already shows.
+ */
+
+#ifndef VGA_CAPTURE_H
+#define VGA_CAPTURE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "pmod_decode.h"
+
+// Largest raster the capture will track
+#define CAPTURE_MAX_WIDTH 2048
+#define CAPTURE_MAX_HEIGHT 2048
+
+// Visible window of standard 640x480 VGA, relative to the sync edges
+// (sync + back porch), used until the first window has been measured
+#define CAPTURE_PRIOR_X 144
+#define CAPTURE_PRIOR_Y 35
+#define CAPTURE_PRIOR_WIDTH 640
+#define CAPTURE_PRIOR_HEIGHT 480
+
+struct CaptureWindow {
+  int x, y, width, height;
+
+  bool operator==(const CaptureWindow& o) const {
+    return x == o.x && y == o.y && width == o.width && height == o.height;
+  }
+  bool operator!=(const CaptureWindow& o) const { return !(*this == o); }
+};
+
+class VgaCapture {
+ public:
+  VgaCapture() : row_version_(CAPTURE_MAX_HEIGHT) { reset(); }
+
+  // Forget all sync and window state, e.g. after a model reset
+  void reset() {
+    window_ = {CAPTURE_PRIOR_X, CAPTURE_PRIOR_Y, CAPTURE_PRIOR_WIDTH, CAPTURE_PRIOR_HEIGHT};
+    candidate_ = window_;
+    prev_hsync_ = true;
+    prev_vsync_ = true;
+    line_locked_ = false;
+    frame_locked_ = false;
+    x_ = 0;
+    y_ = 0;
+    line_period_ = 0;
+    frame_lines_ = 0;
+    vsync_x_ = 0;
+    frames_ = 0;
+    clear_extents();
+    target_ = nullptr;
+    target_argb_ = nullptr;
+    pitch_ = 0;
+    history_.assign((size_t)window_.width * window_.height, 0);
+    history_valid_ = false;
+  }
+
+  // Destination for the pixels of the next frame (pitch in pixels), as
+  // palette indices or decoded to ARGB8888
+  void set_target(uint8_t* pixels, int pitch) {
+    target_ = pixels;
+    target_argb_ = nullptr;
+    pitch_ = pitch;
+  }
+
+  void set_target(uint32_t* pixels, int pitch) {
+    target_ = nullptr;
+    target_argb_ = pixels;
+    pitch_ = pitch;
+  }
+
+  // Add the time spent in scanline decode to *ns from now on (nullptr
+  // stops), for harnesses that profile their stages
+  void set_decode_timer(uint64_t* ns) { decode_ns_ = ns; }
+
+  // Feed one uo_out sample per clock cycle. Returns true when a complete
+  // frame has been written to the target.
+  bool sample(uint8_t uo) {
+    bool hsync = (uo & UO_HSYNC_BIT) != 0;
+    bool vsync = (uo & UO_VSYNC_BIT) != 0;
+    bool done = false;
+
+    if (prev_hsync_ && !hsync) {
+      if (line_locked_) {
+        line_period_ = x_;
+        if (decode_ns_ != nullptr) timed_end_line();
+        else end_line();
+      }
+      line_locked_ = true;
+      x_ = 0;
+      y_++;
+    }
+    if (prev_vsync_ && !vsync) {
+      if (frame_locked_) {
+        frame_lines_ = y_;
+        vsync_x_ = x_;
+        end_frame();
+        done = true;
+      }
+      frame_locked_ = true;
+      y_ = 0;
+    }
+    prev_hsync_ = hsync;
+    prev_vsync_ = vsync;
+
+    if (x_ < CAPTURE_MAX_WIDTH) line_[x_] = uo;
+    x_++;
+    return done;
+  }
+
+  bool locked() const { return line_locked_ && frame_locked_; }
+  const CaptureWindow& window() const { return window_; }
+  int width() const { return window_.width; }
+  int height() const { return window_.height; }
+  int line_period() const { return line_period_; }
+  int frame_lines() const { return frame_lines_; }
+  // Cycles per frame, 0 until a whole frame has been measured
+  uint64_t frame_cycles() const { return (uint64_t)line_period_ * frame_lines_; }
+  // Cycles from the last completed frame's vsync edge to line y, pixel x
+  // (y >= 1), for samplers that skip the capture between pixels
+  uint64_t pixel_offset(int x, int y) const {
+    return (uint64_t)(line_period_ - vsync_x_) + (uint64_t)(y - 1) * line_period_ + x;
+  }
+  uint64_t frames() const { return frames_; }
+
+  // Index of the last frame in which visible row y changed. The frame that
+  // sample() just completed has index frames() - 1.
+  uint64_t row_version(int y) const { return row_version_[y]; }
+
+ private:
+  void clear_extents() {
+    min_x_ = CAPTURE_MAX_WIDTH;
+    max_x_ = -1;
+    min_y_ = CAPTURE_MAX_HEIGHT;
+    max_y_ = -1;
+  }
+
+  // Decode the finished scanline into the target and track where the
+  // design drove visible pixels
+  void end_line() {
+    if (!frame_locked_ || y_ >= CAPTURE_MAX_HEIGHT) return;
+    int n = x_ < CAPTURE_MAX_WIDTH ? x_ : CAPTURE_MAX_WIDTH;
+    int first, last;
+    if (pmod_active_span(line_, n, &first, &last)) {
+      if (first < min_x_) min_x_ = first;
+      if (last > max_x_) max_x_ = last;
+      if (y_ < min_y_) min_y_ = y_;
+      if (y_ > max_y_) max_y_ = y_;
+    }
+
+    int py = y_ - window_.y;
+    if ((target_ == nullptr && target_argb_ == nullptr) || (unsigned)py >= (unsigned)window_.height) {
+      return;
+    }
+    int width = window_.width;
+    if (window_.x + width > n) width = n > window_.x ? n - window_.x : 0;
+    const uint8_t* src = line_ + window_.x;
+    uint8_t* seen = history_.data() + (size_t)py * window_.width;
+    if (!history_valid_ || memcmp(src, seen, width) != 0) {
+      memcpy(seen, src, width);
+      row_version_[py] = frames_;
+    }
+
+    if (target_ != nullptr) {
+      uint8_t* row = target_ + (size_t)py * pitch_;
+      pmod_index_scanline(src, row, width);
+      memset(row + width, 0, window_.width - width);
+    }
+    else {
+      uint32_t* row = target_argb_ + (size_t)py * pitch_;
+      pmod_decode_scanline(src, row, width);
+      for (int i = width; i < window_.width; i++) row[i] = 0xFF000000;
+    }
+  }
+
+  void timed_end_line() {
+    auto start = std::chrono::steady_clock::now();
+    end_line();
+    *decode_ns_ += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+  }
+
+  // Adopt the measured window once it has been seen on two frames in a row.
+  // The target is released so a resized window never writes into it.
+  void end_frame() {
+    frames_++;
+    target_ = nullptr;
+    target_argb_ = nullptr;
+    history_valid_ = true;
+    if (max_x_ >= 0) {
+      CaptureWindow seen = {min_x_, min_y_, max_x_ - min_x_ + 1, max_y_ - min_y_ + 1};
+      if (seen != window_ && seen == candidate_) {
+        // Every row of a moved window counts as changed
+        window_ = seen;
+        history_.assign((size_t)window_.width * window_.height, 0);
+        history_valid_ = false;
+      }
+      candidate_ = seen;
+    }
+    clear_extents();
+  }
+
+  CaptureWindow window_;
+  CaptureWindow candidate_;
+  bool prev_hsync_, prev_vsync_;
+  bool line_locked_, frame_locked_;
+  int x_, y_;
+  int line_period_, frame_lines_;
+  int vsync_x_;  // line position of the vsync edge
+  uint64_t frames_;
+  int min_x_, max_x_, min_y_, max_y_;
+  uint8_t* target_;
+  uint32_t* target_argb_;
+  int pitch_;
+  uint8_t line_[CAPTURE_MAX_WIDTH];
+  std::vector<uint8_t> history_;  // raw bytes of the previous frame's window
+  bool history_valid_;
+  std::vector<uint64_t> row_version_;
+  uint64_t* decode_ns_ = nullptr;
+};
+
+#endif
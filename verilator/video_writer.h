@@ -0,0 +1,194 @@
+/*
+ * Raw video export on a writer thread.
+ *
+ * The writer owns a small pool of frames. The harness decodes straight
+ * into a frame taken with next() and hands it over with submit(). The
+ * writer thread writes it out and returns it to the pool, so frames are
+ * never copied or allocated per frame. When every buffer is queued, next()
+ * waits for the writer rather than dropping a frame.
+ *
+ * Frames are indexed (pmod_decode.h) and only converted on the writer
+ * thread, through per-index tables.
+ *
+ * Formats:
+ *   rgb  raw ARGB8888 (ffmpeg -f rawvideo -pix_fmt bgra)
+ *   y4m  YUV4MPEG2 4:4:4, full range BT.601
+ * Output goes to a file, or stdout for "-", e.g.
+ *   goosegame-replay --video - session.log | ffmpeg -i - out.mp4
+ */
+
+#ifndef VIDEO_WRITER_H
+#define VIDEO_WRITER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "goosegame_sim.h"
+#include "frame_queue.h"
+#include "pmod_decode.h"
+
+#define VIDEO_WRITER_BUFFERS 4
+
+// 25.175 MHz / 420000 cycles per frame, or the real-time rate of a
+// reduced-blanking build's shorter frames
+#if SIM_REDUCED_BLANKING
+#define VIDEO_FPS_NUM 25175000
+#define VIDEO_FPS_DEN FRAME_CYCLES
+#else
+#define VIDEO_FPS_NUM 60000
+#define VIDEO_FPS_DEN 1001
+#endif
+
+enum VideoFormat { VIDEO_Y4M, VIDEO_RGB };
+
+static inline bool video_parse_format(const char* name, VideoFormat* format) {
+  if (strcmp(name, "y4m") == 0) *format = VIDEO_Y4M;
+  else if (strcmp(name, "rgb") == 0) *format = VIDEO_RGB;
+  else return false;
+  return true;
+}
+
+class VideoWriter {
+ public:
+  ~VideoWriter() { close(); }
+
+  // Nothing is written until the first frame fixes the stream size. With
+  // every > 1 the caller keeps one frame in every, and the Y4M rate says so.
+  bool open(const char* path, VideoFormat format, int every = 1) {
+    file_ = strcmp(path, "-") == 0 ? stdout : fopen(path, "wb");
+    if (file_ == nullptr) return false;
+    format_ = format;
+    every_ = every;
+    thread_ = std::thread(&VideoWriter::run, this);
+    return true;
+  }
+
+  bool is_open() const { return file_ != nullptr; }
+  uint64_t written() const { return written_; }
+
+  // A free frame of the given size, or nullptr if the size differs from
+  // the stream (the caller then decodes elsewhere and skips the frame)
+  VideoFrame* next(int width, int height) {
+    if (width_ == 0) start(width, height);
+    if (width != width_ || height != height_) {
+      if (!size_warned_) {
+        fprintf(stderr, "video: skipping %dx%d frames in a %dx%d stream\n", width, height,
+                width_, height_);
+        size_warned_ = true;
+      }
+      return nullptr;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return !free_.empty(); });
+    VideoFrame* frame = free_.back();
+    free_.pop_back();
+    return frame;
+  }
+
+  void submit(VideoFrame* frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_.push_back(frame);
+    cond_.notify_all();
+  }
+
+  // Write out every queued frame and stop the thread
+  void close() {
+    if (file_ == nullptr) return;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closing_ = true;
+      cond_.notify_all();
+    }
+    thread_.join();
+    fflush(file_);
+    if (file_ != stdout) fclose(file_);
+    file_ = nullptr;
+  }
+
+ private:
+  void start(int width, int height) {
+    width_ = width;
+    height_ = height;
+    for (VideoFrame& f : pool_) {
+      f.resize(width, height);
+      free_.push_back(&f);
+    }
+    if (format_ == VIDEO_RGB) argb_.resize((size_t)width * height);
+    if (format_ == VIDEO_Y4M) {
+      planes_.resize((size_t)3 * width * height);
+      for (int i = 0; i < 256; i++) {
+        uint32_t p = pmod_argb((uint8_t)i);
+        int r = (p >> 16) & 0xFF, g = (p >> 8) & 0xFF, b = p & 0xFF;
+        yuv_[i][0] = (uint8_t)((77 * r + 150 * g + 29 * b) >> 8);
+        yuv_[i][1] = (uint8_t)(((-43 * r - 85 * g + 128 * b) >> 8) + 128);
+        yuv_[i][2] = (uint8_t)(((128 * r - 107 * g - 21 * b) >> 8) + 128);
+      }
+      fprintf(file_, "YUV4MPEG2 W%d H%d F%d:%llu Ip A1:1 C444 XCOLORRANGE=FULL\n", width,
+              height, VIDEO_FPS_NUM, (unsigned long long)VIDEO_FPS_DEN * every_);
+    }
+  }
+
+  void run() {
+    for (;;) {
+      VideoFrame* frame;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return !queued_.empty() || closing_; });
+        if (queued_.empty()) return;
+        frame = queued_.front();
+        queued_.pop_front();
+      }
+      write(*frame);
+      written_++;
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_.push_back(frame);
+      cond_.notify_all();
+    }
+  }
+
+  void write(const VideoFrame& frame) {
+    size_t n = frame.pixels.size();
+    if (format_ == VIDEO_RGB) {
+      pmod_expand_indexed(frame.pixels.data(), argb_.data(), (int)n);
+      fwrite(argb_.data(), sizeof(uint32_t), n, file_);
+      return;
+    }
+    uint8_t* y = planes_.data();
+    uint8_t* u = y + n;
+    uint8_t* v = u + n;
+    for (size_t i = 0; i < n; i++) {
+      const uint8_t* c = yuv_[frame.pixels[i]];
+      y[i] = c[0];
+      u[i] = c[1];
+      v[i] = c[2];
+    }
+    fputs("FRAME\n", file_);
+    fwrite(planes_.data(), 1, planes_.size(), file_);
+  }
+
+  FILE* file_ = nullptr;
+  VideoFormat format_ = VIDEO_Y4M;
+  int every_ = 1;
+  int width_ = 0;
+  int height_ = 0;
+  bool size_warned_ = false;
+  VideoFrame pool_[VIDEO_WRITER_BUFFERS];
+  // Conversion buffers, writer thread only
+  std::vector<uint32_t> argb_;
+  std::vector<uint8_t> planes_;
+  uint8_t yuv_[256][3];
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::vector<VideoFrame*> free_;
+  std::deque<VideoFrame*> queued_;
+  bool closing_ = false;
+  uint64_t written_ = 0;
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Work-stealing thread pool for batches of independent jobs.
+ *
+ * Jobs are dealt round-robin into one deque per worker before run(). A
+ * worker takes from the back of its own deque and, once that is empty,
+ * steals from the front of the others, so long jobs on one worker do not
+ * leave the rest idle. run() returns when every job has finished.
+ */
+
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+ public:
+  explicit WorkStealingPool(unsigned workers) {
+    if (workers == 0) workers = 1;
+    for (unsigned i = 0; i < workers; i++) queues_.emplace_back(new Queue);
+  }
+
+  unsigned workers() const { return (unsigned)queues_.size(); }
+
+  void submit(std::function<void()> job) {
+    Queue& q = *queues_[next_++ % queues_.size()];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.jobs.push_back(std::move(job));
+  }
+
+  void run() {
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < queues_.size(); i++) threads.emplace_back(&WorkStealingPool::worker, this, i);
+    for (std::thread& t : threads) t.join();
+  }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> jobs;
+  };
+
+  bool take(unsigned self, std::function<void()>* job) {
+    {
+      Queue& own = *queues_[self];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.jobs.empty()) {
+        *job = std::move(own.jobs.back());
+        own.jobs.pop_back();
+        return true;
+      }
+    }
+    for (size_t i = 1; i < queues_.size(); i++) {
+      Queue& victim = *queues_[(self + i) % queues_.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.jobs.empty()) {
+        *job = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // No jobs are submitted while running, so empty everywhere means done
+  void worker(unsigned self) {
+    std::function<void()> job;
+    while (take(self, &job)) job();
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  size_t next_ = 0;
+};
+
+#endif